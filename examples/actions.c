@@ -88,7 +88,9 @@ _hand_pose_cb (GxrAction *action, GxrPoseEvent *event, Example *self)
            graphene_vec3_get_y (&event->angular_velocity),
            graphene_vec3_get_z (&event->angular_velocity));
 
-  graphene_matrix_print (&event->pose);
+  graphene_matrix_t pose;
+  gxr_rigid_pose_to_matrix (&event->pose, &pose);
+  graphene_matrix_print (&pose);
 }
 
 static void
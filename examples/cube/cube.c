@@ -420,14 +420,6 @@ _iterate_cb (gpointer _self)
   GulkanDevice  *device = gulkan_context_get_device (gc);
   GulkanQueue   *queue = gulkan_device_get_graphics_queue (device);
 
-  gxr_context_poll_events (self->context);
-
-  if (!gxr_context_wait_frame (self->context))
-    {
-      g_printerr ("Failed to wait frame\n");
-      return FALSE;
-    }
-
   if (!gxr_context_begin_frame (self->context))
     return FALSE;
 
@@ -446,7 +438,11 @@ _iterate_cb (gpointer _self)
 static void
 _run (CubeExample *self)
 {
-  self->render_source = g_timeout_add (1, _iterate_cb, self);
+  GSource *source = gxr_context_create_frame_source (self->context, NULL, 0);
+  g_source_set_callback (source, _iterate_cb, self, NULL);
+  self->render_source = g_source_attach (source, NULL);
+  g_source_unref (source);
+
   g_main_loop_run (self->loop);
 }
 
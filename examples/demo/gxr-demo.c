@@ -64,12 +64,8 @@ struct _GxrDemo
   guint render_source;
   bool  shutdown;
   bool  rendering;
-  bool  framecycle;
 
   GxrActionSet *actionset;
-  guint         poll_input_source_id;
-
-  guint poll_runtime_event_source_id;
 
   gulong device_activate_signal;
   gulong device_deactivate_signal;
@@ -124,14 +120,6 @@ _finalize (GObject *gobject)
     g_source_remove (self->render_source);
   self->render_source = 0;
 
-  if (self->poll_runtime_event_source_id > 0)
-    g_source_remove (self->poll_runtime_event_source_id);
-  self->poll_runtime_event_source_id = 0;
-
-  if (self->poll_input_source_id > 0)
-    g_source_remove (self->poll_input_source_id);
-  self->poll_input_source_id = 0;
-
   GxrDeviceManager *dm = gxr_context_get_device_manager (self->context);
   g_signal_handler_disconnect (dm, self->device_activate_signal);
   g_signal_handler_disconnect (dm, self->device_deactivate_signal);
@@ -278,6 +266,9 @@ _render_stereo (GxrDemo *self, VkCommandBuffer cmd_buffer)
   gulkan_render_pass_begin (self->render_pass, extent, black, framebuffer,
                             cmd_buffer);
 
+  /* primes depth, so the scene is not shaded where the lenses hide it */
+  gxr_context_record_visibility_mask (self->context, cmd_buffer, 0);
+
   _render (self, cmd_buffer);
 
   vkCmdEndRenderPass (cmd_buffer);
@@ -293,21 +284,13 @@ _draw (GxrDemo *self)
     _init_renderdoc ();
 #endif
 
-  GulkanContext *gc = gxr_context_get_gulkan (self->context);
-  GulkanDevice  *device = gulkan_context_get_device (gc);
-
-  GulkanQueue *queue = gulkan_device_get_graphics_queue (device);
-
-  GulkanCmdBuffer *cmd_buffer = gulkan_queue_request_cmd_buffer (queue);
-  gulkan_cmd_buffer_begin_one_time (cmd_buffer);
-
-  VkCommandBuffer cmd_handle = gulkan_cmd_buffer_get_handle (cmd_buffer);
+  VkCommandBuffer cmd_handle = gxr_context_begin_frame_commands (self->context);
+  if (cmd_handle == VK_NULL_HANDLE)
+    return;
 
   _render_stereo (self, cmd_handle);
 
-  gulkan_queue_end_submit (queue, cmd_buffer);
-
-  gulkan_queue_free_cmd_buffer (queue, cmd_buffer);
+  gxr_context_submit_frame_commands (self->context);
 
 #if defined(RENDERDOC)
   if (rdoc_api)
@@ -323,15 +306,6 @@ _iterate_cb (gpointer _self)
   if (self->shutdown)
     return FALSE;
 
-  if (!self->framecycle)
-    return TRUE;
-
-  if (!gxr_context_wait_frame (self->context))
-    {
-      g_printerr ("Failed to wait frame\n");
-      return FALSE;
-    }
-
   if (!gxr_context_begin_frame (self->context))
     return FALSE;
 
@@ -441,46 +415,6 @@ _create_wm_action_set (GxrDemo *self)
   return set;
 }
 
-static gboolean
-_poll_runtime_events (GxrDemo *self)
-{
-  if (!self->context)
-    return FALSE;
-
-  gxr_context_poll_events (self->context);
-
-  return TRUE;
-}
-
-static gboolean
-_poll_input_events (GxrDemo *self)
-{
-  if (!self->framecycle)
-    return TRUE;
-
-  if (!self->context)
-    {
-      g_printerr ("Error polling events: No Gxr Context\n");
-      self->poll_input_source_id = 0;
-      return FALSE;
-    }
-
-  if (self->actionset == NULL)
-    {
-      g_printerr ("Error: Action Set not created!\n");
-      return TRUE;
-    }
-
-  if (!gxr_action_sets_poll (&self->actionset, 1))
-    {
-      g_printerr ("Error polling actions\n");
-      self->poll_input_source_id = 0;
-      return FALSE;
-    }
-
-  return TRUE;
-}
-
 static void
 _init_input_callbacks (GxrDemo *self)
 {
@@ -495,10 +429,20 @@ _init_input_callbacks (GxrDemo *self)
 
   self->actionset = _create_wm_action_set (self);
   gxr_context_attach_action_sets (self->context, &self->actionset, 1);
+}
 
-  self->poll_input_source_id = g_timeout_add (3,
-                                              (GSourceFunc) _poll_input_events,
-                                              self);
+static void
+_init_frame_source (GxrDemo *self)
+{
+  uint32_t action_set_count = self->actionset ? 1 : 0;
+  GSource *source = gxr_context_create_frame_source (self->context,
+                                                     &self->actionset,
+                                                     action_set_count);
+  g_assert (source);
+
+  g_source_set_callback (source, _iterate_cb, self, NULL);
+  self->render_source = g_source_attach (source, NULL);
+  g_source_unref (source);
 }
 
 static void
@@ -514,10 +458,7 @@ _state_change_cb (GxrContext          *context,
         g_main_loop_quit (self->loop);
         break;
       case GXR_STATE_FRAMECYCLE_START:
-        self->framecycle = TRUE;
-        break;
       case GXR_STATE_FRAMECYCLE_STOP:
-        self->framecycle = FALSE;
         break;
       case GXR_STATE_RENDERING_START:
         self->rendering = TRUE;
@@ -628,6 +569,9 @@ _init_vulkan (GxrDemo *self)
 
   if (!_init_framebuffers (self))
     return FALSE;
+  /* the uniform buffers are updated in place, so wait for the last frame */
+  if (!gxr_context_init_frame_resources (self->context, 1))
+    return FALSE;
   if (!_init_descriptor_pool (self))
     return FALSE;
   if (!_init_graphics_pipelines (self))
@@ -648,8 +592,6 @@ gxr_demo_init (GxrDemo *self)
 {
   self->shutdown = false;
 
-  self->poll_runtime_event_source_id = 0;
-  self->poll_input_source_id = 0;
   self->actionset = NULL;
   self->context = NULL;
   self->near = 0.05f;
@@ -663,8 +605,6 @@ gxr_demo_init (GxrDemo *self)
 
   self->loop = g_main_loop_new (NULL, FALSE);
 
-  self->render_source = g_timeout_add (1, _iterate_cb, self);
-
   self->sigint_signal = g_unix_signal_add (SIGINT, _sigint_cb, self);
 
   self->context = _create_gxr_context ();
@@ -695,10 +635,7 @@ gxr_demo_init (GxrDemo *self)
 
   _init_input_callbacks (self);
 
-  self->poll_runtime_event_source_id = g_timeout_add (20,
-                                                      (GSourceFunc)
-                                                        _poll_runtime_events,
-                                                      self);
+  _init_frame_source (self);
 
   g_signal_connect (self->context, "state-change-event",
                     (GCallback) _state_change_cb, self);
@@ -12,6 +12,7 @@
 #include "gxr-action-set.h"
 #include "gxr-context-private.h"
 #include "gxr-controller.h"
+#include "gxr-space-locator.h"
 
 // TODO: Do not hardcode this
 #define NUM_HANDS 2
@@ -34,6 +35,8 @@ struct _GxrAction
   /* only used when this action is a pose action*/
   XrSpace hand_spaces[NUM_HANDS];
   XrSpace tracked_space;
+  /* located together with the other spaces, see gxr_context_locate_space */
+  uint32_t hand_space_slots[NUM_HANDS];
 
   XrAction handle;
 
@@ -103,6 +106,7 @@ gxr_action_init (GxrAction *self)
   for (int i = 0; i < NUM_HANDS; i++)
     {
       self->hand_spaces[i] = XR_NULL_HANDLE;
+      self->hand_space_slots[i] = GXR_SPACE_LOCATOR_INVALID_SLOT;
       self->last_float[i] = 0.0f;
       self->last_bool[i] = FALSE;
 
@@ -117,8 +121,8 @@ gxr_action_new (GxrContext *context)
 {
   GxrAction *self = (GxrAction *) g_object_new (GXR_TYPE_ACTION, 0);
 
-  /* TODO: Handle this more nicely */
-  self->context = context;
+  /* released in finalize, which still removes the located hand spaces */
+  self->context = g_object_ref (context);
   self->instance = gxr_context_get_openxr_instance (context);
   self->session = gxr_context_get_openxr_session (context);
   self->tracked_space = gxr_context_get_tracked_space (context);
@@ -231,7 +235,12 @@ gxr_action_new_from_type_url (GxrContext   *context,
                           buffer);
               g_object_unref (self);
               self = NULL;
+              break;
             }
+
+          self->hand_space_slots[i]
+            = gxr_context_add_located_space (self->context,
+                                             self->hand_spaces[i]);
         }
     }
   return self;
@@ -479,36 +488,9 @@ _action_poll_vec2f (GxrAction *self)
   return TRUE;
 }
 
-static gboolean
-_space_location_valid (XrSpaceLocation *sl)
-{
-  return
-    /* (sl->locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT)    != 0 && */
-    (sl->locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0;
-}
-
-static void
-_get_model_matrix_from_pose (XrPosef *pose, graphene_matrix_t *mat)
-{
-  graphene_quaternion_t q;
-  graphene_quaternion_init (&q, pose->orientation.x, pose->orientation.y,
-                            pose->orientation.z, pose->orientation.w);
-
-  graphene_matrix_init_identity (mat);
-  graphene_matrix_rotate_quaternion (mat, &q);
-  graphene_point3d_t translation = {
-    pose->position.x,
-    pose->position.y,
-    pose->position.z,
-  };
-  graphene_matrix_translate (mat, &translation);
-}
-
 static gboolean
 _action_poll_pose_secs_from_now (GxrAction *self, float secs)
 {
-  (void) secs;
-
   GxrDeviceManager *dm = gxr_context_get_device_manager (self->context);
   GSList           *controllers = gxr_device_manager_get_controllers (dm);
 
@@ -537,44 +519,26 @@ _action_poll_pose_secs_from_now (GxrAction *self, float secs)
           continue;
         }
 
-      gboolean        spaceLocationValid;
-      XrSpaceLocation space_location = {
-        .type = XR_TYPE_SPACE_LOCATION,
-      };
-
-      /* TODO: secs from now ignored, API not appropriate for OpenXR */
-      XrTime time = gxr_context_get_predicted_display_time (self->context);
-
-      XrSpace hand_space = self->hand_spaces[controller_handle];
-      result = xrLocateSpace (hand_space, self->tracked_space, time,
-                              &space_location);
-
-      if (result != XR_SUCCESS)
+      /* secs from now are predicted by the runtime, which may extrapolate */
+      GxrPosePrediction prediction;
+      uint32_t          slot = self->hand_space_slots[controller_handle];
+      if (!gxr_context_predict_space (self->context, slot, secs, FALSE,
+                                      &prediction))
         {
           g_debug ("Failed to poll hand space location");
           continue;
         }
 
-      spaceLocationValid = _space_location_valid (&space_location);
-
-      /*
-      g_print("Polled space %s active %d  valid %d, %f %f %f\n", self->url,
-              value.isActive, spaceLocationValid,
-              space_location.pose.position.x,
-              space_location.pose.position.y,
-              space_location.pose.position.z
-      );
-      */
-
       GxrPoseEvent event = {
         .active = value.isActive == XR_TRUE,
         .controller = controller,
-        .valid = spaceLocationValid,
+        .valid = prediction.valid,
         .device_connected = value.isActive == XR_TRUE,
       };
-      _get_model_matrix_from_pose (&space_location.pose, &event.pose);
-      graphene_vec3_init (&event.velocity, 0, 0, 0);
-      graphene_vec3_init (&event.angular_velocity, 0, 0, 0);
+      event.pose = prediction.pose;
+      graphene_vec3_init_from_vec3 (&event.velocity, &prediction.velocity);
+      graphene_vec3_init_from_vec3 (&event.angular_velocity,
+                                    &prediction.angular_velocity);
 
       gxr_action_emit_pose (GXR_ACTION (self), &event);
     }
@@ -641,12 +605,37 @@ gxr_action_trigger_haptic (GxrAction *self,
   return result == XR_SUCCESS;
 }
 
+/*
+ * The pose of a pose action at a monotonic time in microseconds, from the
+ * poses published by the frame loop. Safe to call from any thread.
+ */
+gboolean
+gxr_action_sample_pose (GxrAction         *self,
+                        guint64            controller_handle,
+                        int64_t            time,
+                        GxrPosePrediction *prediction)
+{
+  if (controller_handle >= NUM_HANDS)
+    return FALSE;
+
+  uint32_t slot = self->hand_space_slots[controller_handle];
+  if (slot == GXR_SPACE_LOCATOR_INVALID_SLOT)
+    return FALSE;
+
+  return gxr_context_sample_space (self->context, slot, time, prediction);
+}
+
 static void
 gxr_action_finalize (GObject *gobject)
 {
   GxrAction *self = GXR_ACTION (gobject);
+  for (int i = 0; i < NUM_HANDS; i++)
+    if (self->hand_space_slots[i] != GXR_SPACE_LOCATOR_INVALID_SLOT)
+      gxr_context_remove_located_space (self->context,
+                                        self->hand_space_slots[i]);
   if (self->haptic_action)
     g_clear_object (&self->haptic_action);
+  g_clear_object (&self->context);
   g_free (self->url);
 }
 
@@ -79,6 +79,12 @@ gxr_action_trigger_haptic (GxrAction *self,
                            float      amplitude,
                            guint64    controller_handle);
 
+gboolean
+gxr_action_sample_pose (GxrAction         *self,
+                        guint64            controller_handle,
+                        int64_t            time,
+                        GxrPosePrediction *prediction);
+
 GxrActionType
 gxr_action_get_action_type (GxrAction *self);
 
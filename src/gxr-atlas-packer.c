@@ -0,0 +1,152 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-atlas-packer.h"
+
+/*
+ * Shelf packer: rects are placed left to right on horizontal shelves that
+ * are stacked from the top. Released space on a shelf is only reclaimed
+ * once the whole shelf is empty, fragmentation is resolved by clearing and
+ * packing again.
+ */
+
+typedef struct
+{
+  uint32_t y;
+  uint32_t height;
+  uint32_t width_used;
+  uint32_t rect_count;
+} GxrAtlasShelf;
+
+struct _GxrAtlasPacker
+{
+  VkExtent2D extent;
+  GArray    *shelves;
+};
+
+GxrAtlasPacker *
+gxr_atlas_packer_new (VkExtent2D extent)
+{
+  GxrAtlasPacker *self = g_new (GxrAtlasPacker, 1);
+  self->extent = extent;
+  self->shelves = g_array_new (FALSE, FALSE, sizeof (GxrAtlasShelf));
+  return self;
+}
+
+void
+gxr_atlas_packer_free (GxrAtlasPacker *self)
+{
+  g_array_free (self->shelves, TRUE);
+  g_free (self);
+}
+
+static uint32_t
+_get_shelves_height (GxrAtlasPacker *self)
+{
+  if (self->shelves->len == 0)
+    return 0;
+  GxrAtlasShelf *last = &g_array_index (self->shelves, GxrAtlasShelf,
+                                        self->shelves->len - 1);
+  return last->y + last->height;
+}
+
+/* Finds the shelf that wastes the least height, or NULL. */
+static GxrAtlasShelf *
+_find_shelf (GxrAtlasPacker *self, VkExtent2D extent)
+{
+  GxrAtlasShelf *best = NULL;
+  for (guint i = 0; i < self->shelves->len; i++)
+    {
+      GxrAtlasShelf *shelf = &g_array_index (self->shelves, GxrAtlasShelf, i);
+      if (shelf->height < extent.height
+          || shelf->width_used + extent.width > self->extent.width)
+        continue;
+
+      if (!best || shelf->height < best->height)
+        best = shelf;
+    }
+  return best;
+}
+
+/* Returns FALSE if there is no space left for extent. */
+gboolean
+gxr_atlas_packer_alloc (GxrAtlasPacker *self,
+                        VkExtent2D      extent,
+                        VkRect2D       *rect)
+{
+  if (extent.width == 0 || extent.height == 0
+      || extent.width > self->extent.width
+      || extent.height > self->extent.height)
+    return FALSE;
+
+  GxrAtlasShelf *shelf = _find_shelf (self, extent);
+  if (!shelf)
+    {
+      uint32_t y = _get_shelves_height (self);
+      if (y + extent.height > self->extent.height)
+        return FALSE;
+
+      GxrAtlasShelf new_shelf = {
+        .y = y,
+        .height = extent.height,
+        .width_used = 0,
+        .rect_count = 0,
+      };
+      g_array_append_val (self->shelves, new_shelf);
+      shelf = &g_array_index (self->shelves, GxrAtlasShelf,
+                              self->shelves->len - 1);
+    }
+
+  *rect = (VkRect2D){
+    .offset = {
+      .x = (int32_t) shelf->width_used,
+      .y = (int32_t) shelf->y,
+    },
+    .extent = extent,
+  };
+  shelf->width_used += extent.width;
+  shelf->rect_count++;
+
+  return TRUE;
+}
+
+void
+gxr_atlas_packer_release (GxrAtlasPacker *self, const VkRect2D *rect)
+{
+  for (guint i = 0; i < self->shelves->len; i++)
+    {
+      GxrAtlasShelf *shelf = &g_array_index (self->shelves, GxrAtlasShelf, i);
+      if (shelf->y != (uint32_t) rect->offset.y)
+        continue;
+
+      g_return_if_fail (shelf->rect_count > 0);
+      if (--shelf->rect_count == 0)
+        shelf->width_used = 0;
+      break;
+    }
+
+  /* empty shelves at the bottom give their height back */
+  while (self->shelves->len > 0)
+    {
+      GxrAtlasShelf *last = &g_array_index (self->shelves, GxrAtlasShelf,
+                                            self->shelves->len - 1);
+      if (last->rect_count > 0)
+        break;
+      g_array_set_size (self->shelves, self->shelves->len - 1);
+    }
+}
+
+void
+gxr_atlas_packer_clear (GxrAtlasPacker *self)
+{
+  g_array_set_size (self->shelves, 0);
+}
+
+VkExtent2D
+gxr_atlas_packer_get_extent (GxrAtlasPacker *self)
+{
+  return self->extent;
+}
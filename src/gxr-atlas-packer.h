@@ -0,0 +1,36 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_ATLAS_PACKER_H_
+#define GXR_ATLAS_PACKER_H_
+
+#include <glib.h>
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+typedef struct _GxrAtlasPacker GxrAtlasPacker;
+
+GxrAtlasPacker *
+gxr_atlas_packer_new (VkExtent2D extent);
+
+void
+gxr_atlas_packer_free (GxrAtlasPacker *self);
+
+gboolean
+gxr_atlas_packer_alloc (GxrAtlasPacker *self,
+                        VkExtent2D      extent,
+                        VkRect2D       *rect);
+
+void
+gxr_atlas_packer_release (GxrAtlasPacker *self, const VkRect2D *rect);
+
+void
+gxr_atlas_packer_clear (GxrAtlasPacker *self);
+
+VkExtent2D
+gxr_atlas_packer_get_extent (GxrAtlasPacker *self);
+
+#endif /* GXR_ATLAS_PACKER_H_ */
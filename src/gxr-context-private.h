@@ -10,7 +10,9 @@
 
 #include "gxr-context.h"
 
+#include "gxr-layer.h"
 #include "gxr-manifest.h"
+#include "gxr-space-locator.h"
 
 XrInstance
 gxr_context_get_openxr_instance (GxrContext *self);
@@ -21,10 +23,51 @@ gxr_context_get_openxr_session (GxrContext *self);
 XrSpace
 gxr_context_get_tracked_space (GxrContext *self);
 
+XrSpace
+gxr_context_get_view_space (GxrContext *self);
+
 XrTime
 gxr_context_get_predicted_display_time (GxrContext *self);
 
 XrSessionState
 gxr_context_get_session_state (GxrContext *self);
 
+uint32_t
+gxr_context_add_located_space (GxrContext *self, XrSpace space);
+
+void
+gxr_context_remove_located_space (GxrContext *self, uint32_t slot);
+
+gboolean
+gxr_context_locate_space_relation (GxrContext       *self,
+                                   XrSpace           space,
+                                   XrSpace           base_space,
+                                   XrTime            time,
+                                   GxrSpaceRelation *relation);
+
+gboolean
+gxr_context_locate_space (GxrContext       *self,
+                          uint32_t          slot,
+                          XrTime            time,
+                          GxrSpaceRelation *relation);
+
+gboolean
+gxr_context_predict_space (GxrContext        *self,
+                           uint32_t           slot,
+                           float              secs_from_now,
+                           gboolean           extrapolate,
+                           GxrPosePrediction *prediction);
+
+gboolean
+gxr_context_sample_space (GxrContext        *self,
+                          uint32_t           slot,
+                          int64_t            time,
+                          GxrPosePrediction *prediction);
+
+void
+gxr_context_add_layer (GxrContext *self, GxrLayer *layer);
+
+void
+gxr_context_remove_layer (GxrContext *self, GxrLayer *layer);
+
 #endif /* GXR_CONTEXT_PRIVATE_H_ */
@@ -7,18 +7,77 @@
 
 #include "gxr-context-private.h"
 
+#include <math.h>
+#include <time.h>
+
 #define XR_USE_PLATFORM_XLIB 1
 #define XR_USE_GRAPHICS_API_VULKAN 1
+#define XR_USE_TIMESPEC 1
 #include <openxr/openxr.h>
 #include <openxr/openxr_platform.h>
 #include <openxr/openxr_reflection.h>
 
+#include "graphene-ext.h"
 #include "gxr-controller.h"
+#include "gxr-frame-history.h"
+#include "gxr-atlas-packer.h"
+#include "gxr-layer-private.h"
+#include "gxr-pose-service.h"
+#include "gxr-slack-scheduler.h"
+#include "gxr-space-cache.h"
+#include "gxr-space-locator.h"
+#include "gxr-thread-scheduling.h"
 #include "gxr-version.h"
+#include "gxr-visibility-mask.h"
 
 // TODO: Do not hardcode this
 #define NUM_CONTROLLERS 2
 
+#define NSEC_PER_USEC 1000
+#define NSEC_PER_SEC 1000000000
+
+/* just in time frame start, margins in microseconds */
+#define FRAME_START_MIN_HISTORY 16
+#define FRAME_START_MARGIN_INITIAL 2000
+#define FRAME_START_MARGIN_MIN 1000
+#define FRAME_START_MARGIN_STEP 250
+#define FRAME_START_DECAY_FRAMES 90
+
+/* default head motion bounds for reusing the previous frame */
+#define FRAME_REUSE_MAX_ANGLE 5.0f
+#define FRAME_REUSE_MAX_DISTANCE 0.05f
+
+/* dynamic resolution aims for GPU time at this fraction of the period */
+#define DYNAMIC_RESOLUTION_TARGET 0.8f
+#define DYNAMIC_RESOLUTION_DAMPING 0.25f
+/* relative scale changes below this are ignored */
+#define DYNAMIC_RESOLUTION_DEADBAND 0.02f
+
+/* recommended workload when the runtime reports a performance problem */
+#define PERF_WARNING_QUALITY_SCALE 0.75f
+#define PERF_IMPAIRED_QUALITY_SCALE 0.5f
+
+/* runtime events are polled at this interval in ms when no frame is due */
+#define FRAME_SOURCE_EVENT_INTERVAL 20
+
+/* slack tasks stop this long in microseconds before the next frame starts */
+#define SLACK_MARGIN 500
+
+/* default size of the atlas that demoted layers are copied into */
+#define LAYER_ATLAS_SIZE 4096
+
+/*
+ * Field of view change in radians that rebuilds the visibility mask mesh,
+ * about a pixel at the edge of current displays. The mask only covers
+ * hidden area, so smaller changes are not worth a new mesh.
+ */
+#define VISIBILITY_MASK_FOV_EPSILON 0.002f
+
+/* views rendered together with multiview into one array swapchain */
+#define VIEW_PAIR_SIZE 2
+/* stereo, or stereo with a foveal inset pair in quad view mode */
+#define MAX_VIEW_PAIRS 2
+
 enum GxrSwapchainType
 {
   GxrSwapchainTypeColor = 0,
@@ -34,13 +93,52 @@ struct GxrSwapchain
   XrSwapchainImageVulkanKHR *images;
   /* last acquired swapchain image index per swapchain */
   uint32_t buffer_index;
+  /* buffer_index is acquired in the current frame */
+  gboolean acquired;
   /* for each view */
-  uint32_t length;
-  VkFormat format;
+  uint32_t   length;
+  VkFormat   format;
+  VkExtent2D extent;
 
   enum GxrSwapchainType swapchain_type;
 };
 
+/* Per-frame state returned by xrWaitFrame */
+struct GxrWaitedFrame
+{
+  XrResult   result;
+  XrTime     predicted_display_time;
+  XrDuration predicted_display_period;
+  gboolean   should_render;
+  /* monotonic time xrWaitFrame returned at */
+  int64_t returned;
+};
+
+/* Per swapchain image command recording, see
+ * gxr_context_init_frame_resources */
+struct GxrFrameResource
+{
+  VkCommandBuffer cmd_buffer;
+  VkFence         fence;
+  /* submission order, to find the oldest frame in flight */
+  uint64_t serial;
+  gboolean pending;
+};
+
+/* A visibility mask mesh that frames in flight may still draw */
+struct GxrRetiredMesh
+{
+  GulkanVertexBuffer *mesh;
+  /* serial of the last frame submission that may use the mesh */
+  uint64_t serial;
+};
+
+enum GxrFrameRequest
+{
+  GxrFrameRequestWait = 1,
+  GxrFrameRequestStop,
+};
+
 struct _GxrContext
 {
   GObject        parent;
@@ -51,6 +149,13 @@ struct _GxrContext
     gboolean vulkan_enable2;
     gboolean overlay;
     gboolean depth;
+    gboolean cylinder;
+    gboolean equirect2;
+    gboolean visibility_mask;
+    gboolean performance_settings;
+    gboolean quad_views;
+    gboolean locate_spaces;
+    gboolean convert_timespec_time;
   } extensions;
   XrEnvironmentBlendMode blend_mode;
 
@@ -64,11 +169,22 @@ struct _GxrContext
   XrSystemId              system_id;
   XrViewConfigurationType view_config_type;
 
-  // We use one swapchain per type, use GxrSwapchainType as index
-  struct GxrSwapchain swapchain[GxrSwapchainTypeLast];
-
-  /* 1 framebuffer for each swapchain image, for each swapchain (1 per view) */
-  GulkanFrameBuffer   **framebuffers;
+  /* head and action spaces, located together relative to play_space */
+  GxrSpaceLocator *space_locator;
+  uint32_t         head_space_slot;
+  /* relations located at predicted_display_time */
+  GxrSpaceCache space_cache;
+  /* the same relations for other threads */
+  GxrPoseService pose_service;
+  /* NULL without XR_KHR_convert_timespec_time */
+  PFN_xrConvertTimeToTimespecTimeKHR convert_time_to_timespec;
+
+  /* One swapchain per view pair and type, use GxrSwapchainType as index */
+  struct GxrSwapchain swapchain[MAX_VIEW_PAIRS][GxrSwapchainTypeLast];
+  uint32_t            view_pair_count;
+
+  /* 1 framebuffer for each swapchain image, for each view pair */
+  GulkanFrameBuffer   **framebuffers[MAX_VIEW_PAIRS];
   VkExtent2D            framebuffer_extent;
   VkSampleCountFlagBits framebuffer_sample_count;
 
@@ -92,14 +208,116 @@ struct _GxrContext
 
   XrCompositionLayerProjection projection_layer;
 
-  volatile XrTime     predicted_display_time;
-  volatile XrDuration predicted_display_period;
+  XrTime     predicted_display_time;
+  XrDuration predicted_display_period;
 
-  XrView *views;
+  XrView  *views;
+  /* relocated views of gxr_context_late_latch_views */
+  XrView  *latched_views;
+  /* latched_views wait for gxr_context_apply_late_latch */
+  gboolean late_latch_pending;
 
   XrVersion desired_vk_version;
 
-  GMutex wait_frame_mutex;
+  /* Pipelined mode: the frame thread blocks in xrWaitFrame and hands the
+   * waited frames to the render thread through waited_frames. It only waits
+   * for the next frame once it receives a request, which the render thread
+   * sends after xrBeginFrame. */
+  GThread     *frame_thread;
+  GAsyncQueue *frame_requests;
+  GAsyncQueue *waited_frames;
+  gboolean     frame_requested;
+  /* waited before pipelining was disabled, but not yet consumed */
+  struct GxrWaitedFrame *pending_frame;
+  /* handed out by wait_frame, but neither begun nor skipped yet */
+  gboolean frame_unbegun;
+
+  /* timestamps of the frame in progress */
+  GxrFrameTimestamps frame_timestamps;
+  GxrFrameHistory    frame_history;
+  /* GPU time reported since the last frame ended, 0 if none arrived */
+  int64_t last_gpu_duration;
+
+  /* Just in time frame start: delay the start of the frame so that the
+   * predicted CPU and GPU work finishes right before the deadline. */
+  gboolean frame_start_scheduling;
+  gboolean frame_start_pending;
+  int64_t  frame_deadline;
+  int64_t  frame_start_margin;
+  uint32_t frames_since_miss;
+
+  /* Frame reuse: resubmit the previously rendered projection layer */
+  gboolean frame_reuse_requested;
+  gboolean frame_reused;
+  gboolean have_rendered_frame;
+  float    frame_reuse_max_angle;
+  float    frame_reuse_max_distance;
+
+  /* Dynamic resolution: render into a scaled imageRect of the swapchain */
+  gboolean dynamic_resolution;
+  float    resolution_scale;
+  float    min_resolution_scale;
+  float    max_resolution_scale;
+
+  /*
+   * Woken up by the frame thread, see gxr_context_create_frame_source. The
+   * context owns a ref, so the frame thread can use it under the mutex.
+   */
+  GSource *frame_source;
+  GMutex   frame_source_mutex;
+
+  VkCommandPool            frame_command_pool;
+  struct GxrFrameResource *frame_resources;
+  uint32_t                 frame_resource_count;
+  uint32_t                 max_frames_in_flight;
+  uint64_t                 frame_serial;
+  /* resource the commands of the current frame are recorded into */
+  struct GxrFrameResource *recording_frame_resource;
+
+  /* deferrable work run after gxr_context_end_frame */
+  GxrSlackScheduler *slack_scheduler;
+
+  /* applied by the frame thread when it starts */
+  GxrThreadConfig *frame_thread_config;
+  /* granted GxrThreadScheduling per GxrThreadRole, set by the threads */
+  gint thread_scheduling[GXR_THREAD_LAST];
+
+  /* GxrLayer, not owned, sorted by order when the frame ends */
+  GSList  *layers;
+  uint32_t layers_submitted;
+  uint32_t layers_updated;
+  uint32_t layers_demoted;
+
+  /* runtime limit including the projection layer, 0 if unknown */
+  uint32_t        max_layer_count;
+  GxrAtlasPacker *layer_atlas;
+  /* demoted layers are copied into this quad, created once needed */
+  struct GxrSwapchain     atlas_swapchain;
+  XrCompositionLayerQuad  atlas_layer;
+  VkCommandPool           atlas_command_pool;
+  struct GxrFrameResource atlas_commands;
+  /* rects or content of demoted layers changed since the last copy */
+  gboolean atlas_dirty;
+  gboolean atlas_has_content;
+
+  /* hidden area per view, NULL without XR_KHR_visibility_mask */
+  GxrVisibilityMask  *visibility_masks;
+  GulkanVertexBuffer *visibility_mask_mesh;
+  /* the views of a pair are contiguous in the mesh */
+  uint32_t visibility_mask_vertex_counts[MAX_VIEW_PAIRS];
+  /* field of view per view the mesh was built for */
+  XrFovf  *visibility_mask_fovs;
+  gboolean visibility_mask_changed;
+  /* struct GxrRetiredMesh, freed once their frames completed */
+  GSList *retired_visibility_mask_meshes;
+  /* depth only, for the render pass of gxr_context_init_framebuffers */
+  VkPipelineLayout visibility_mask_layout;
+  VkPipeline       visibility_mask_pipeline;
+
+  /* last reported level per domain and sub domain */
+  GxrPerfNotificationLevel
+    perf_levels[GXR_PERF_DOMAIN_LAST][GXR_PERF_SUB_DOMAIN_LAST];
+  float quality_scale;
 };
 
 G_DEFINE_TYPE (GxrContext, gxr_context, G_TYPE_OBJECT)
@@ -108,6 +326,8 @@ enum
 {
   STATE_CHANGE_EVENT,
   OVERLAY_EVENT,
+  FRAME_MISSED_EVENT,
+  PERFORMANCE_EVENT,
   LAST_SIGNAL
 };
 
@@ -131,6 +351,16 @@ gxr_context_class_init (GxrContextClass *klass)
     = g_signal_new ("overlay-event", G_TYPE_FROM_CLASS (klass),
                     G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 1,
                     G_TYPE_POINTER | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  context_signals[FRAME_MISSED_EVENT]
+    = g_signal_new ("frame-missed-event", G_TYPE_FROM_CLASS (klass),
+                    G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 1,
+                    G_TYPE_POINTER | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  context_signals[PERFORMANCE_EVENT]
+    = g_signal_new ("performance-event", G_TYPE_FROM_CLASS (klass),
+                    G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 1,
+                    G_TYPE_POINTER | G_SIGNAL_TYPE_STATIC_SCOPE);
 }
 
 static const char *viewport_config_name = "/viewport_configuration/vr";
@@ -230,6 +460,61 @@ _check_extensions (GxrContext *self)
   g_debug ("%s extension supported: %d", XR_EXTX_OVERLAY_EXTENSION_NAME,
            self->extensions.overlay);
 
+  self->extensions.cylinder
+    = _is_extension_supported (XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME,
+                               instanceExtensionProperties,
+                               instanceExtensionCount);
+  g_debug ("%s extension supported: %d",
+           XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME,
+           self->extensions.cylinder);
+
+  self->extensions.equirect2 = _is_extension_supported (
+    XR_KHR_COMPOSITION_LAYER_EQUIRECT2_EXTENSION_NAME,
+    instanceExtensionProperties, instanceExtensionCount);
+  g_debug ("%s extension supported: %d",
+           XR_KHR_COMPOSITION_LAYER_EQUIRECT2_EXTENSION_NAME,
+           self->extensions.equirect2);
+
+  self->extensions.visibility_mask
+    = _is_extension_supported (XR_KHR_VISIBILITY_MASK_EXTENSION_NAME,
+                               instanceExtensionProperties,
+                               instanceExtensionCount);
+  g_debug ("%s extension supported: %d", XR_KHR_VISIBILITY_MASK_EXTENSION_NAME,
+           self->extensions.visibility_mask);
+
+  self->extensions.performance_settings
+    = _is_extension_supported (XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME,
+                               instanceExtensionProperties,
+                               instanceExtensionCount);
+  g_debug ("%s extension supported: %d",
+           XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME,
+           self->extensions.performance_settings);
+
+  /* the app needs to render four views, so quad views are opt in */
+  self->extensions.quad_views
+    = _is_extension_supported (XR_VARJO_QUAD_VIEWS_EXTENSION_NAME,
+                               instanceExtensionProperties,
+                               instanceExtensionCount);
+  g_debug ("%s extension supported: %d", XR_VARJO_QUAD_VIEWS_EXTENSION_NAME,
+           self->extensions.quad_views);
+  if (g_strcmp0 (g_getenv ("GXR_VIEW_CONFIG"), "QUAD") != 0)
+    self->extensions.quad_views = FALSE;
+
+  self->extensions.locate_spaces
+    = _is_extension_supported (XR_KHR_LOCATE_SPACES_EXTENSION_NAME,
+                               instanceExtensionProperties,
+                               instanceExtensionCount);
+  g_debug ("%s extension supported: %d", XR_KHR_LOCATE_SPACES_EXTENSION_NAME,
+           self->extensions.locate_spaces);
+
+  self->extensions.convert_timespec_time
+    = _is_extension_supported (XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME,
+                               instanceExtensionProperties,
+                               instanceExtensionCount);
+  g_debug ("%s extension supported: %d",
+           XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME,
+           self->extensions.convert_timespec_time);
+
   g_free (instanceExtensionProperties);
 
   if (!self->extensions.vulkan_enable2)
@@ -284,7 +569,7 @@ static gboolean
 _create_instance (GxrContext *self, char *app_name, uint32_t app_version)
 {
 
-  const char *enabled_extensions[10] = {
+  const char *enabled_extensions[12] = {
     XR_KHR_VULKAN_ENABLE2_EXTENSION_NAME,
   };
   // vulkan_enable2 is required
@@ -302,6 +587,48 @@ _create_instance (GxrContext *self, char *app_name, uint32_t app_version)
         = XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME;
     }
 
+  if (self->extensions.cylinder)
+    {
+      enabled_extensions[enabled_extension_count++]
+        = XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME;
+    }
+
+  if (self->extensions.equirect2)
+    {
+      enabled_extensions[enabled_extension_count++]
+        = XR_KHR_COMPOSITION_LAYER_EQUIRECT2_EXTENSION_NAME;
+    }
+
+  if (self->extensions.visibility_mask)
+    {
+      enabled_extensions[enabled_extension_count++]
+        = XR_KHR_VISIBILITY_MASK_EXTENSION_NAME;
+    }
+
+  if (self->extensions.performance_settings)
+    {
+      enabled_extensions[enabled_extension_count++]
+        = XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME;
+    }
+
+  if (self->extensions.quad_views)
+    {
+      enabled_extensions[enabled_extension_count++]
+        = XR_VARJO_QUAD_VIEWS_EXTENSION_NAME;
+    }
+
+  if (self->extensions.locate_spaces)
+    {
+      enabled_extensions[enabled_extension_count++]
+        = XR_KHR_LOCATE_SPACES_EXTENSION_NAME;
+    }
+
+  if (self->extensions.convert_timespec_time)
+    {
+      enabled_extensions[enabled_extension_count++]
+        = XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME;
+    }
+
   XrInstanceCreateInfo instanceCreateInfo = {
     .type = XR_TYPE_INSTANCE_CREATE_INFO,
     .createFlags = 0,
@@ -359,6 +686,9 @@ _create_system (GxrContext *self)
   if (!_check_xr_result (result, "Failed to get System properties"))
     return FALSE;
 
+  self->max_layer_count = systemProperties.graphicsProperties.maxLayerCount;
+  g_debug ("Runtime supports %u composition layers", self->max_layer_count);
+
   return TRUE;
 }
 
@@ -383,6 +713,18 @@ _set_up_views (GxrContext *self)
 
   self->view_config_type = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
 
+  if (self->extensions.quad_views)
+    {
+      for (uint32_t i = 0; i < viewConfigurationCount; ++i)
+        if (viewConfigurations[i]
+            == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO)
+          self->view_config_type = viewConfigurations[i];
+
+      if (self->view_config_type
+          != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO)
+        g_info ("Quad views requested, but the system has none.");
+    }
+
   /* if struct (more specifically .type) is still 0 after searching, then
    we have not found the config. This way we don't need to set a bool
    found to TRUE. */
@@ -421,11 +763,22 @@ _set_up_views (GxrContext *self)
                                               self->view_config_type, 0,
                                               &self->view_count, NULL);
 
+  if (self->view_count % VIEW_PAIR_SIZE != 0
+      || self->view_count > MAX_VIEW_PAIRS * VIEW_PAIR_SIZE)
+    {
+      g_printerr ("Unsupported view count %d.\n", self->view_count);
+      return FALSE;
+    }
+  self->view_pair_count = self->view_count / VIEW_PAIR_SIZE;
+  g_debug ("Using %d views", self->view_count);
+
   self->views = g_malloc (sizeof (XrView) * self->view_count);
+  self->latched_views = g_malloc (sizeof (XrView) * self->view_count);
   for (uint32_t i = 0; i < self->view_count; i++)
     {
       self->views[i].type = XR_TYPE_VIEW;
       self->views[i].next = NULL;
+      self->latched_views[i] = self->views[i];
     }
 
   if (!_check_xr_result (result,
@@ -651,10 +1004,37 @@ _destroy_session (GxrContext *self)
   return TRUE;
 }
 
+/* Queries the Vulkan images of a created swapchain. */
+static gboolean
+_enumerate_swapchain_images (struct GxrSwapchain *swapchain)
+{
+  XrResult result = xrEnumerateSwapchainImages (swapchain->handle, 0,
+                                                &swapchain->length, NULL);
+  if (!_check_xr_result (result, "Failed to enumerate swapchains"))
+    return FALSE;
+
+  swapchain->images = g_malloc (sizeof (XrSwapchainImageVulkanKHR)
+                                * swapchain->length);
+
+  for (uint32_t j = 0; j < swapchain->length; j++)
+    {
+      // ...IMAGE_VULKAN2_KHR = ...IMAGE_VULKAN_KHR
+      swapchain->images[j].type = XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR;
+      swapchain->images[j].next = NULL;
+    }
+
+  result = xrEnumerateSwapchainImages (swapchain->handle, swapchain->length,
+                                       &swapchain->length,
+                                       (XrSwapchainImageBaseHeader *)
+                                         swapchain->images);
+  return _check_xr_result (result, "Failed to enumerate swapchain images");
+}
+
 static gboolean
 _create_swapchain (GxrContext           *self,
                    struct GxrSwapchain  *swapchain,
-                   enum GxrSwapchainType swapchain_type)
+                   enum GxrSwapchainType swapchain_type,
+                   uint32_t              pair)
 {
   XrResult result;
   uint32_t swapchainFormatCount;
@@ -745,60 +1125,42 @@ _create_swapchain (GxrContext           *self,
   /* make sure we don't clean up uninitialized pointer on failure */
   swapchain->images = NULL;
 
+  /* the layers of the pair share the size, so it fits the larger view */
+  swapchain->extent = (VkExtent2D){0, 0};
+  for (uint32_t i = 0; i < swapchain->array_size; i++)
+    {
+      XrViewConfigurationView *view
+        = &self->configuration_views[pair * VIEW_PAIR_SIZE + i];
+      swapchain->extent.width = MAX (swapchain->extent.width,
+                                     view->recommendedImageRectWidth);
+      swapchain->extent.height = MAX (swapchain->extent.height,
+                                      view->recommendedImageRectHeight);
+    }
+
   XrSwapchainCreateInfo swapchainCreateInfo = {
     .type = XR_TYPE_SWAPCHAIN_CREATE_INFO,
     .usageFlags = usage_flags,
     .createFlags = 0,
     .format = swapchain->format,
     .sampleCount = 1,
-    .width = self->configuration_views[0].recommendedImageRectWidth,
-    .height = self->configuration_views[0].recommendedImageRectHeight,
+    .width = swapchain->extent.width,
+    .height = swapchain->extent.height,
     .faceCount = 1,
-    .arraySize = 2,
+    .arraySize = swapchain->array_size,
     .mipCount = 1,
   };
 
-  g_debug ("Swapchain %d dimensions: %dx%d", 0,
-           self->configuration_views[0].recommendedImageRectWidth,
-           self->configuration_views[0].recommendedImageRectHeight);
+  g_debug ("Swapchain %d dimensions: %dx%d", pair, swapchain->extent.width,
+           swapchain->extent.height);
 
   result = xrCreateSwapchain (self->session, &swapchainCreateInfo,
                               &swapchain->handle);
-  if (!_check_xr_result (result, "Failed to create swapchain %d!", 0))
-    {
-      g_free (swapchainFormats);
-      return FALSE;
-    }
-
-  result = xrEnumerateSwapchainImages (swapchain->handle, 0, &swapchain->length,
-                                       NULL);
-  if (!_check_xr_result (result, "Failed to enumerate swapchains"))
-    {
-      g_free (swapchainFormats);
-      return FALSE;
-    }
-
-  swapchain->images = g_malloc (sizeof (XrSwapchainImageVulkanKHR)
-                                * swapchain->length);
-
-  for (uint32_t j = 0; j < swapchain->length; j++)
-    {
-      // ...IMAGE_VULKAN2_KHR = ...IMAGE_VULKAN_KHR
-      swapchain->images[j].type = XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR;
-      swapchain->images[j].next = NULL;
-    }
-
-  result = xrEnumerateSwapchainImages (swapchain->handle, swapchain->length,
-                                       &swapchain->length,
-                                       (XrSwapchainImageBaseHeader *)
-                                         swapchain->images);
-  if (!_check_xr_result (result, "Failed to enumerate swapchain images"))
-    {
-      g_free (swapchainFormats);
-      return FALSE;
-    }
-
   g_free (swapchainFormats);
+  if (!_check_xr_result (result, "Failed to create swapchain %d!", pair))
+    return FALSE;
+
+  if (!_enumerate_swapchain_images (swapchain))
+    return FALSE;
 
   swapchain->swapchain_type = swapchain_type;
 
@@ -808,23 +1170,43 @@ _create_swapchain (GxrContext           *self,
 static gboolean
 _create_swapchains (GxrContext *self)
 {
-  if (!_create_swapchain (self, &self->swapchain[GxrSwapchainTypeColor],
-                          GxrSwapchainTypeColor))
+  for (uint32_t i = 0; i < self->view_pair_count; i++)
     {
-      g_printerr ("Failed to create color swapchain");
-      return FALSE;
-    }
+      struct GxrSwapchain *swapchains = self->swapchain[i];
+      if (!_create_swapchain (self, &swapchains[GxrSwapchainTypeColor],
+                              GxrSwapchainTypeColor, i))
+        {
+          g_printerr ("Failed to create color swapchain");
+          return FALSE;
+        }
 
-  if (!_create_swapchain (self, &self->swapchain[GxrSwapchainTypeDepth],
-                          GxrSwapchainTypeDepth))
-    {
-      g_printerr ("Failed to create depth swapchain");
-      return FALSE;
+      if (!_create_swapchain (self, &swapchains[GxrSwapchainTypeDepth],
+                              GxrSwapchainTypeDepth, i))
+        {
+          g_printerr ("Failed to create depth swapchain");
+          return FALSE;
+        }
     }
 
   return TRUE;
 }
 
+static void
+_fetch_visibility_masks (GxrContext *self)
+{
+  if (!self->extensions.visibility_mask)
+    return;
+
+  self->visibility_masks = g_new0 (GxrVisibilityMask, self->view_count);
+  self->visibility_mask_fovs = g_new0 (XrFovf, self->view_count);
+
+  for (uint32_t i = 0; i < self->view_count; i++)
+    gxr_visibility_mask_fetch (&self->visibility_masks[i], self->instance,
+                               self->session, self->view_config_type, i);
+
+  self->visibility_mask_changed = TRUE;
+}
+
 static void
 _create_projection_views (GxrContext *self)
 {
@@ -835,14 +1217,15 @@ _create_projection_views (GxrContext *self)
     self->projection_views[i] = (XrCompositionLayerProjectionView) {
       .type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW,
       .subImage = {
-        .swapchain = self->swapchain[GxrSwapchainTypeColor].handle,
+        .swapchain = self->swapchain[i / VIEW_PAIR_SIZE]
+                                    [GxrSwapchainTypeColor].handle,
         .imageRect = {
           .extent = {
               .width = (int32_t) self->configuration_views[i].recommendedImageRectWidth,
               .height = (int32_t) self->configuration_views[i].recommendedImageRectHeight,
           },
         },
-        .imageArrayIndex = i,
+        .imageArrayIndex = i % VIEW_PAIR_SIZE,
       },
     };
 
@@ -857,14 +1240,15 @@ _create_projection_views (GxrContext *self)
           {
             .type = XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR,
           .subImage = {
-            .swapchain = self->swapchain[GxrSwapchainTypeDepth].handle,
+            .swapchain = self->swapchain[i / VIEW_PAIR_SIZE]
+                                        [GxrSwapchainTypeDepth].handle,
             .imageRect = {
               .extent = {
                 .width = (int32_t) self->configuration_views[i].recommendedImageRectWidth,
                 .height = (int32_t) self->configuration_views[i].recommendedImageRectHeight,
               },
             },
-            .imageArrayIndex = i,
+            .imageArrayIndex = i % VIEW_PAIR_SIZE,
           },
           };
 
@@ -909,6 +1293,22 @@ _init_session (GxrContext *self)
   if (!_check_supported_spaces (self))
     return FALSE;
 
+  self->space_locator = gxr_space_locator_new (self->instance, self->session,
+                                               self->extensions.locate_spaces);
+  self->head_space_slot = gxr_space_locator_add (self->space_locator,
+                                                 self->view_space);
+
+  if (self->extensions.convert_timespec_time)
+    {
+      XrResult res = xrGetInstanceProcAddr (self->instance,
+                                            "xrConvertTimeToTimespecTimeKHR",
+                                            (PFN_xrVoidFunction *) &self
+                                              ->convert_time_to_timespec);
+      if (!_check_xr_result (res, "Failed to load "
+                                  "xrConvertTimeToTimespecTimeKHR."))
+        self->convert_time_to_timespec = NULL;
+    }
+
   if (!_begin_session (self))
     return FALSE;
 
@@ -919,8 +1319,14 @@ _init_session (GxrContext *self)
 
   _create_projection_views (self);
 
-  self->swapchain[GxrSwapchainTypeColor].buffer_index = 0;
-  self->swapchain[GxrSwapchainTypeDepth].buffer_index = 0;
+  _fetch_visibility_masks (self);
+
+  for (uint32_t i = 0; i < self->view_pair_count; i++)
+    for (uint32_t j = 0; j < GxrSwapchainTypeLast; j++)
+      {
+        self->swapchain[i][j].buffer_index = 0;
+        self->swapchain[i][j].acquired = FALSE;
+      }
 
   self->session_state = XR_SESSION_STATE_UNKNOWN;
   self->should_render = FALSE;
@@ -1358,7 +1764,6 @@ _new (GSList  *instance_ext_list,
       return NULL;
     }
 
-  g_mutex_init (&self->wait_frame_mutex);
   return self;
 }
 
@@ -1385,15 +1790,98 @@ gxr_context_init (GxrContext *self)
   self->device_manager = gxr_device_manager_new ();
   self->view_count = 0;
   self->views = NULL;
+  self->latched_views = NULL;
+  self->late_latch_pending = FALSE;
   self->predicted_display_time = 0;
   self->predicted_display_period = 0;
-  self->framebuffers = NULL;
-
-  self->swapchain[GxrSwapchainTypeColor].array_size = 2;
-  self->swapchain[GxrSwapchainTypeColor].images = NULL;
-
-  self->swapchain[GxrSwapchainTypeDepth].array_size = 2;
-  self->swapchain[GxrSwapchainTypeDepth].images = NULL;
+  for (uint32_t i = 0; i < MAX_VIEW_PAIRS; i++)
+    self->framebuffers[i] = NULL;
+
+  self->frame_thread = NULL;
+  self->frame_requests = NULL;
+  self->waited_frames = NULL;
+  self->frame_requested = FALSE;
+  self->pending_frame = NULL;
+  self->frame_unbegun = FALSE;
+
+  self->frame_timestamps = (GxrFrameTimestamps){0};
+  self->last_gpu_duration = 0;
+  gxr_frame_history_init (&self->frame_history);
+  gxr_space_cache_init (&self->space_cache);
+  gxr_pose_service_init (&self->pose_service);
+  self->convert_time_to_timespec = NULL;
+
+  self->frame_start_scheduling = FALSE;
+  self->frame_start_pending = FALSE;
+  self->frame_deadline = 0;
+  self->frame_start_margin = FRAME_START_MARGIN_INITIAL;
+  self->frames_since_miss = 0;
+
+  self->frame_reuse_requested = FALSE;
+  self->frame_reused = FALSE;
+  self->have_rendered_frame = FALSE;
+  self->frame_reuse_max_angle = FRAME_REUSE_MAX_ANGLE;
+  self->frame_reuse_max_distance = FRAME_REUSE_MAX_DISTANCE;
+
+  self->dynamic_resolution = FALSE;
+  self->resolution_scale = 1.0f;
+  self->min_resolution_scale = 1.0f;
+  self->max_resolution_scale = 1.0f;
+  self->quality_scale = 1.0f;
+
+  self->frame_source = NULL;
+  g_mutex_init (&self->frame_source_mutex);
+
+  self->frame_command_pool = VK_NULL_HANDLE;
+  self->frame_resources = NULL;
+  self->frame_resource_count = 0;
+  self->max_frames_in_flight = 0;
+  self->frame_serial = 0;
+  self->recording_frame_resource = NULL;
+
+  self->slack_scheduler = gxr_slack_scheduler_new ();
+
+  self->frame_thread_config = NULL;
+  self->layers = NULL;
+  self->layers_submitted = 0;
+  self->layers_updated = 0;
+  self->layers_demoted = 0;
+  self->max_layer_count = 0;
+  self->visibility_masks = NULL;
+  self->visibility_mask_mesh = NULL;
+  for (uint32_t i = 0; i < MAX_VIEW_PAIRS; i++)
+    self->visibility_mask_vertex_counts[i] = 0;
+  self->visibility_mask_fovs = NULL;
+  self->visibility_mask_changed = FALSE;
+  self->retired_visibility_mask_meshes = NULL;
+  self->visibility_mask_layout = VK_NULL_HANDLE;
+  self->visibility_mask_pipeline = VK_NULL_HANDLE;
+  self->layer_atlas = gxr_atlas_packer_new ((VkExtent2D){
+    .width = LAYER_ATLAS_SIZE,
+    .height = LAYER_ATLAS_SIZE,
+  });
+  self->atlas_swapchain = (struct GxrSwapchain){0};
+  self->atlas_layer = (XrCompositionLayerQuad){
+    .type = XR_TYPE_COMPOSITION_LAYER_QUAD,
+    .layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
+    .eyeVisibility = XR_EYE_VISIBILITY_BOTH,
+    .pose = {.orientation = {.w = 1.0f}},
+    .size = {1.0f, 1.0f},
+  };
+  self->atlas_command_pool = VK_NULL_HANDLE;
+  self->atlas_commands = (struct GxrFrameResource){0};
+  self->atlas_dirty = FALSE;
+  self->atlas_has_content = FALSE;
+  for (uint32_t i = 0; i < GXR_THREAD_LAST; i++)
+    self->thread_scheduling[i] = GXR_THREAD_SCHEDULING_DEFAULT;
+
+  self->view_pair_count = 0;
+  for (uint32_t i = 0; i < MAX_VIEW_PAIRS; i++)
+    for (uint32_t j = 0; j < GxrSwapchainTypeLast; j++)
+      {
+        self->swapchain[i][j].array_size = VIEW_PAIR_SIZE;
+        self->swapchain[i][j].images = NULL;
+      }
 
   self->desired_vk_version = XR_MAKE_VERSION (1, 2, 0);
 }
@@ -1409,9 +1897,34 @@ _cleanup_swapchain (GxrContext *self, struct GxrSwapchain *swapchain)
     g_free (swapchain->images);
 }
 
+static void
+_stop_frame_thread (GxrContext *self);
+
+static void
+_cleanup_frame_resources (GxrContext *self);
+
+static void
+_clear_frame_source (GxrContext *self);
+
+static void
+_free_retired_mesh (gpointer data);
+
+static void
+_clear_visibility_mask_pipeline (GxrContext *self);
+
+static void
+_clear_layer_atlas (GxrContext *self);
+
 static void
 _cleanup (GxrContext *self)
 {
+  if (self->frame_thread)
+    _stop_frame_thread (self);
+  _clear_frame_source (self);
+  g_free (self->pending_frame);
+
+  _cleanup_frame_resources (self);
+  _clear_layer_atlas (self);
 
   if (self->play_space)
     xrDestroySpace (self->play_space);
@@ -1423,23 +1936,41 @@ _cleanup (GxrContext *self)
   g_free (self->configuration_views);
 
   g_free (self->views);
+  g_free (self->latched_views);
   g_free (self->projection_views);
 
-  if (self->framebuffers)
+  if (self->visibility_masks)
+    {
+      for (uint32_t i = 0; i < self->view_count; i++)
+        gxr_visibility_mask_clear (&self->visibility_masks[i]);
+      g_clear_pointer (&self->visibility_masks, g_free);
+    }
+  g_clear_pointer (&self->visibility_mask_fovs, g_free);
+  g_clear_object (&self->visibility_mask_mesh);
+  /* frames in flight were waited for with the frame resources */
+  g_slist_free_full (g_steal_pointer (&self->retired_visibility_mask_meshes),
+                     _free_retired_mesh);
+  _clear_visibility_mask_pipeline (self);
+
+  for (uint32_t p = 0; p < MAX_VIEW_PAIRS; p++)
     {
-      for (uint32_t i = 0; i < self->swapchain[GxrSwapchainTypeColor].length;
-           i++)
+      struct GxrSwapchain *swapchains = self->swapchain[p];
+      if (self->framebuffers[p])
         {
-          if (GULKAN_IS_FRAME_BUFFER (self->framebuffers[i]))
-            g_object_unref (self->framebuffers[i]);
-          else
-            g_printerr ("Failed to release framebuffer %d\n", i);
+          for (uint32_t i = 0; i < swapchains[GxrSwapchainTypeColor].length;
+               i++)
+            {
+              if (GULKAN_IS_FRAME_BUFFER (self->framebuffers[p][i]))
+                g_object_unref (self->framebuffers[p][i]);
+              else
+                g_printerr ("Failed to release framebuffer %d\n", i);
+            }
+          g_free (self->framebuffers[p]);
         }
-      g_free (self->framebuffers);
-    }
 
-  _cleanup_swapchain (self, &self->swapchain[GxrSwapchainTypeColor]);
-  _cleanup_swapchain (self, &self->swapchain[GxrSwapchainTypeDepth]);
+      _cleanup_swapchain (self, &swapchains[GxrSwapchainTypeColor]);
+      _cleanup_swapchain (self, &swapchains[GxrSwapchainTypeDepth]);
+    }
 }
 
 static void
@@ -1461,6 +1992,13 @@ gxr_context_finalize (GObject *gobject)
 
   g_debug ("destroyed up gxr context, bye");
 
+  g_mutex_clear (&self->frame_source_mutex);
+  gxr_slack_scheduler_free (self->slack_scheduler);
+  gxr_atlas_packer_free (self->layer_atlas);
+  g_clear_pointer (&self->space_locator, gxr_space_locator_free);
+  gxr_space_cache_clear (&self->space_cache);
+  g_free (self->frame_thread_config);
+
   G_OBJECT_CLASS (gxr_context_parent_class)->finalize (gobject);
 }
 
@@ -1471,96 +2009,461 @@ gxr_context_get_gulkan (GxrContext *self)
 }
 
 static gboolean
-_space_location_valid (XrSpaceLocation *sl)
+_space_location_valid (XrSpaceLocationFlags flags)
 {
-  return (sl->locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0
-         && (sl->locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0;
+  return (flags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0
+         && (flags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0;
 }
 
-static void
-_get_model_matrix_from_pose (XrPosef *pose, graphene_matrix_t *mat)
+/* Returns a slot for gxr_context_locate_space. */
+uint32_t
+gxr_context_add_located_space (GxrContext *self, XrSpace space)
 {
-  graphene_quaternion_t q;
-  graphene_quaternion_init (&q, pose->orientation.x, pose->orientation.y,
-                            pose->orientation.z, pose->orientation.w);
-
-  graphene_matrix_t rotation;
-  graphene_matrix_init_identity (&rotation);
-  graphene_matrix_rotate_quaternion (&rotation, &q);
-
-  graphene_point3d_t position = {
-    pose->position.x,
-    pose->position.y,
-    pose->position.z,
-  };
-
-  graphene_matrix_t translation;
-  graphene_matrix_init_translate (&translation, &position);
-
-  graphene_matrix_multiply (&rotation, &translation, mat);
+  return gxr_space_locator_add (self->space_locator, space);
 }
 
-gboolean
-gxr_context_get_head_pose (GxrContext *self, graphene_matrix_t *pose)
+void
+gxr_context_remove_located_space (GxrContext *self, uint32_t slot)
 {
-  XrSpaceLocation space_location = {
-    .type = XR_TYPE_SPACE_LOCATION,
-  };
+  gxr_space_locator_remove (self->space_locator, slot);
+}
 
-  XrResult result = xrLocateSpace (self->view_space, self->play_space,
-                                   self->predicted_display_time,
-                                   &space_location);
-  _check_xr_result (result, "Failed to locate head space.");
+static gboolean
+_locate_registered_spaces (GxrContext *self)
+{
+  XrTime time = self->predicted_display_time;
+  if (!gxr_space_locator_update (self->space_locator, self->play_space, time))
+    return FALSE;
 
-  gboolean valid = _space_location_valid (&space_location);
-  if (!valid)
+  const XrSpace                *spaces;
+  const XrSpaceLocationDataKHR *locations;
+  const XrSpaceVelocityDataKHR *velocities;
+  uint32_t count = gxr_space_locator_get_located (self->space_locator, &spaces,
+                                                  &locations, &velocities);
+  for (uint32_t i = 0; i < count; i++)
     {
-      g_printerr ("Could not get valid head pose.\n");
-      graphene_matrix_init_identity (pose);
-      return FALSE;
+      GxrSpaceRelation relation = {
+        .location = locations[i],
+        .velocity = velocities[i],
+      };
+      gxr_space_cache_insert (&self->space_cache, spaces[i], self->play_space,
+                              time, &relation);
     }
 
-  _get_model_matrix_from_pose (&space_location.pose, pose);
   return TRUE;
 }
 
-#define PI 3.1415926535f
-#define RAD_TO_DEG(x) ((x) *360.0f / (2.0f * PI))
-
-void
-gxr_context_get_frustum_angles (GxrContext *self,
-                                GxrEye      eye,
-                                float      *left,
-                                float      *right,
-                                float      *top,
-                                float      *bottom)
+/*
+ * Converts to the clock of g_get_monotonic_time. Without
+ * XR_KHR_convert_timespec_time the display is assumed at the frame deadline.
+ */
+static int64_t
+_xr_time_to_monotonic (GxrContext *self, XrTime time)
 {
-  *left = RAD_TO_DEG (self->views[eye].fov.angleLeft);
-  *right = RAD_TO_DEG (self->views[eye].fov.angleRight);
-  *top = RAD_TO_DEG (self->views[eye].fov.angleUp);
-  *bottom = RAD_TO_DEG (self->views[eye].fov.angleDown);
+  if (self->convert_time_to_timespec)
+    {
+      struct timespec ts;
+      XrResult        res = self->convert_time_to_timespec (self->instance,
+                                                             time, &ts);
+      if (res == XR_SUCCESS)
+        return (int64_t) ts.tv_sec * G_USEC_PER_SEC
+               + ts.tv_nsec / NSEC_PER_USEC;
+    }
 
-  // g_debug ("Fov angles L %f R %f T %f B %f", *left, *right, *top, *bottom);
+  return self->frame_deadline
+         + (time - self->predicted_display_time) / NSEC_PER_USEC;
 }
 
+/* Makes the relations of the frame available to gxr_context_sample_space. */
 static void
-_handle_visibility_changed (GxrContext *self, XrEventDataBuffer *runtimeEvent)
+_publish_poses (GxrContext *self)
 {
-  XrEventDataMainSessionVisibilityChangedEXTX *event
-    = (XrEventDataMainSessionVisibilityChangedEXTX *) runtimeEvent;
+  if (!self->space_locator || !_locate_registered_spaces (self))
+    return;
 
-  g_debug ("Event: main session visibility now: %d", event->visible);
-
-  GxrOverlayEvent overlay_event = {
-    .main_session_visible = event->visible,
-  };
-  g_signal_emit (self, context_signals[OVERLAY_EVENT], 0, &overlay_event);
+  int64_t time = _xr_time_to_monotonic (self, self->predicted_display_time);
+  gxr_pose_service_begin_write (&self->pose_service, time);
+  for (uint32_t slot = 0; slot < GXR_POSE_SERVICE_MAX_SLOTS; slot++)
+    {
+      GxrSpaceRelation relation = {0};
+      XrSpace          space = gxr_space_locator_get_space (self->space_locator,
+                                                            slot);
+      if (space != XR_NULL_HANDLE)
+        gxr_space_cache_peek (&self->space_cache, space, self->play_space,
+                              &relation);
+      gxr_pose_service_write (&self->pose_service, slot, &relation);
+    }
+  gxr_pose_service_end_write (&self->pose_service);
 }
 
-static void
-_handle_state_changed (GxrContext *self, XrEventDataBuffer *runtimeEvent)
-{
-  XrEventDataSessionStateChanged *event = (XrEventDataSessionStateChanged *)
+/*
+ * Locates space relative to base_space with its velocity. At the predicted
+ * display time this happens once per frame, and a miss on a registered
+ * space relative to the play space locates all registered spaces at once.
+ */
+gboolean
+gxr_context_locate_space_relation (GxrContext       *self,
+                                   XrSpace           space,
+                                   XrSpace           base_space,
+                                   XrTime            time,
+                                   GxrSpaceRelation *relation)
+{
+  if (gxr_space_cache_lookup (&self->space_cache, space, base_space, time,
+                              relation))
+    return TRUE;
+
+  if (time == self->predicted_display_time && base_space == self->play_space
+      && gxr_space_locator_contains (self->space_locator, space))
+    {
+      if (!_locate_registered_spaces (self))
+        return FALSE;
+      return gxr_space_cache_peek (&self->space_cache, space, base_space,
+                                   relation);
+    }
+
+  if (!gxr_space_locator_locate_one (self->space_locator, space, base_space,
+                                     time, relation))
+    return FALSE;
+
+  gxr_space_cache_insert (&self->space_cache, space, base_space, time,
+                          relation);
+
+  return TRUE;
+}
+
+/* Locates a registered space relative to the play space. */
+gboolean
+gxr_context_locate_space (GxrContext       *self,
+                          uint32_t          slot,
+                          XrTime            time,
+                          GxrSpaceRelation *relation)
+{
+  XrSpace space = gxr_space_locator_get_space (self->space_locator, slot);
+  if (space == XR_NULL_HANDLE)
+    return FALSE;
+
+  return gxr_context_locate_space_relation (self, space, self->play_space,
+                                            time, relation);
+}
+
+static void
+_relation_to_prediction (GxrSpaceRelation  *relation,
+                         GxrPosePrediction *prediction)
+{
+  XrSpaceLocationFlags    flags = relation->location.locationFlags;
+  XrSpaceVelocityDataKHR *v = &relation->velocity;
+
+  prediction->valid = (flags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0;
+  prediction->position_valid = (flags & XR_SPACE_LOCATION_POSITION_VALID_BIT)
+                               != 0;
+  gxr_rigid_pose_init_from_xr (&prediction->pose, &relation->location.pose);
+
+  graphene_vec3_init (&prediction->velocity, 0, 0, 0);
+  graphene_vec3_init (&prediction->angular_velocity, 0, 0, 0);
+  if (v->velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT)
+    graphene_vec3_init (&prediction->velocity, v->linearVelocity.x,
+                        v->linearVelocity.y, v->linearVelocity.z);
+  if (v->velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT)
+    graphene_vec3_init (&prediction->angular_velocity, v->angularVelocity.x,
+                        v->angularVelocity.y, v->angularVelocity.z);
+}
+
+/*
+ * Predicts a registered space secs_from_now after the predicted display
+ * time, either by asking the runtime for that time or by extrapolating the
+ * relation of the frame.
+ */
+gboolean
+gxr_context_predict_space (GxrContext        *self,
+                           uint32_t           slot,
+                           float              secs_from_now,
+                           gboolean           extrapolate,
+                           GxrPosePrediction *prediction)
+{
+  XrTime time = self->predicted_display_time;
+  if (!extrapolate)
+    time += (XrTime) ((double) secs_from_now * NSEC_PER_SEC);
+
+  GxrSpaceRelation relation;
+  if (!gxr_context_locate_space (self, slot, time, &relation))
+    return FALSE;
+
+  prediction->extrapolated = extrapolate && secs_from_now != 0.0f;
+  prediction->error_bound = 0.0f;
+  if (prediction->extrapolated)
+    prediction->error_bound = gxr_space_relation_extrapolate (&relation,
+                                                              secs_from_now);
+
+  _relation_to_prediction (&relation, prediction);
+
+  return TRUE;
+}
+
+gboolean
+gxr_context_predict_head_pose (GxrContext        *self,
+                               float              secs_from_now,
+                               gboolean           extrapolate,
+                               GxrPosePrediction *prediction)
+{
+  return gxr_context_predict_space (self, self->head_space_slot,
+                                    secs_from_now, extrapolate, prediction);
+}
+
+/*
+ * Extrapolates the relation published for slot to time, a monotonic time in
+ * microseconds. Does not touch the session, so it may be called from any
+ * thread.
+ */
+gboolean
+gxr_context_sample_space (GxrContext        *self,
+                          uint32_t           slot,
+                          int64_t            time,
+                          GxrPosePrediction *prediction)
+{
+  GxrSpaceRelation relation;
+  int64_t          located;
+  if (!gxr_pose_service_read (&self->pose_service, slot, &relation, &located))
+    return FALSE;
+
+  float dt = (float) (time - located) / G_USEC_PER_SEC;
+
+  prediction->extrapolated = dt != 0.0f;
+  prediction->error_bound = gxr_space_relation_extrapolate (&relation, dt);
+
+  _relation_to_prediction (&relation, prediction);
+
+  return TRUE;
+}
+
+gboolean
+gxr_context_sample_head_pose (GxrContext        *self,
+                              int64_t            time,
+                              GxrPosePrediction *prediction)
+{
+  return gxr_context_sample_space (self, self->head_space_slot, time,
+                                   prediction);
+}
+
+gboolean
+gxr_context_get_head_pose (GxrContext *self, graphene_matrix_t *pose)
+{
+  GxrSpaceRelation relation = {0};
+  if (!gxr_context_locate_space (self, self->head_space_slot,
+                                 self->predicted_display_time, &relation))
+    g_printerr ("Failed to locate head space.\n");
+
+  gboolean valid = _space_location_valid (relation.location.locationFlags);
+  if (!valid)
+    {
+      g_printerr ("Could not get valid head pose.\n");
+      graphene_matrix_init_identity (pose);
+      return FALSE;
+    }
+
+  GxrRigidPose head;
+  gxr_rigid_pose_init_from_xr (&head, &relation.location.pose);
+  gxr_rigid_pose_to_matrix (&head, pose);
+  return TRUE;
+}
+
+#define PI 3.1415926535f
+#define RAD_TO_DEG(x) ((x) *360.0f / (2.0f * PI))
+
+/* Quad view eyes are out of range when the runtime only provides stereo. */
+static gboolean
+_has_view (GxrContext *self, GxrEye eye)
+{
+  if ((uint32_t) eye < self->view_count)
+    return TRUE;
+
+  g_warning ("Eye %d is out of range for %d views.\n", eye, self->view_count);
+  return FALSE;
+}
+
+void
+gxr_context_get_frustum_angles (GxrContext *self,
+                                GxrEye      eye,
+                                float      *left,
+                                float      *right,
+                                float      *top,
+                                float      *bottom)
+{
+  if (self->views == NULL || !_has_view (self, eye))
+    {
+      *left = *right = *top = *bottom = 0.0f;
+      return;
+    }
+
+  *left = RAD_TO_DEG (self->views[eye].fov.angleLeft);
+  *right = RAD_TO_DEG (self->views[eye].fov.angleRight);
+  *top = RAD_TO_DEG (self->views[eye].fov.angleUp);
+  *bottom = RAD_TO_DEG (self->views[eye].fov.angleDown);
+
+  // g_debug ("Fov angles L %f R %f T %f B %f", *left, *right, *top, *bottom);
+}
+
+static void
+_handle_visibility_changed (GxrContext *self, XrEventDataBuffer *runtimeEvent)
+{
+  XrEventDataMainSessionVisibilityChangedEXTX *event
+    = (XrEventDataMainSessionVisibilityChangedEXTX *) runtimeEvent;
+
+  g_debug ("Event: main session visibility now: %d", event->visible);
+
+  GxrOverlayEvent overlay_event = {
+    .main_session_visible = event->visible,
+  };
+  g_signal_emit (self, context_signals[OVERLAY_EVENT], 0, &overlay_event);
+}
+
+/* the runtime quality scale caps the scale, but never below the minimum */
+static float
+_get_max_resolution_scale (GxrContext *self)
+{
+  return MAX (self->min_resolution_scale,
+              MIN (self->max_resolution_scale, self->quality_scale));
+}
+
+/* workload the renderer should aim for at each notification level */
+static float
+_quality_scale_for_level (GxrPerfNotificationLevel level)
+{
+  switch (level)
+    {
+      case GXR_PERF_NOTIFICATION_IMPAIRED:
+        return PERF_IMPAIRED_QUALITY_SCALE;
+      case GXR_PERF_NOTIFICATION_WARNING:
+        return PERF_WARNING_QUALITY_SCALE;
+      default:
+        return 1.0f;
+    }
+}
+
+static gboolean
+_perf_domain_from_xr (XrPerfSettingsDomainEXT domain, GxrPerfDomain *out)
+{
+  switch (domain)
+    {
+      case XR_PERF_SETTINGS_DOMAIN_CPU_EXT:
+        *out = GXR_PERF_DOMAIN_CPU;
+        return TRUE;
+      case XR_PERF_SETTINGS_DOMAIN_GPU_EXT:
+        *out = GXR_PERF_DOMAIN_GPU;
+        return TRUE;
+      default:
+        return FALSE;
+    }
+}
+
+static gboolean
+_perf_sub_domain_from_xr (XrPerfSettingsSubDomainEXT sub_domain,
+                          GxrPerfSubDomain          *out)
+{
+  switch (sub_domain)
+    {
+      case XR_PERF_SETTINGS_SUB_DOMAIN_COMPOSITING_EXT:
+        *out = GXR_PERF_SUB_DOMAIN_COMPOSITING;
+        return TRUE;
+      case XR_PERF_SETTINGS_SUB_DOMAIN_RENDERING_EXT:
+        *out = GXR_PERF_SUB_DOMAIN_RENDERING;
+        return TRUE;
+      case XR_PERF_SETTINGS_SUB_DOMAIN_THERMAL_EXT:
+        *out = GXR_PERF_SUB_DOMAIN_THERMAL;
+        return TRUE;
+      default:
+        return FALSE;
+    }
+}
+
+static GxrPerfNotificationLevel
+_perf_notification_level_from_xr (XrPerfSettingsNotificationLevelEXT level)
+{
+  switch (level)
+    {
+      case XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT:
+        return GXR_PERF_NOTIFICATION_IMPAIRED;
+      case XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT:
+        return GXR_PERF_NOTIFICATION_WARNING;
+      default:
+        return GXR_PERF_NOTIFICATION_NORMAL;
+    }
+}
+
+/*
+ * The worst level of any domain limits the workload, a hot GPU does not
+ * cool down because the CPU is fine.
+ */
+static void
+_update_quality_scale (GxrContext *self)
+{
+  float scale = 1.0f;
+  for (uint32_t i = 0; i < GXR_PERF_DOMAIN_LAST; i++)
+    for (uint32_t j = 0; j < GXR_PERF_SUB_DOMAIN_LAST; j++)
+      scale = fminf (scale,
+                     _quality_scale_for_level (self->perf_levels[i][j]));
+
+  self->quality_scale = scale;
+
+  if (self->dynamic_resolution)
+    self->resolution_scale = CLAMP (self->resolution_scale,
+                                    self->min_resolution_scale,
+                                    _get_max_resolution_scale (self));
+}
+
+static void
+_handle_perf_settings (GxrContext *self, XrEventDataBuffer *runtimeEvent)
+{
+  XrEventDataPerfSettingsEXT *event = (XrEventDataPerfSettingsEXT *)
+    runtimeEvent;
+
+  GxrPerformanceEvent perf_event;
+  if (!_perf_domain_from_xr (event->domain, &perf_event.domain)
+      || !_perf_sub_domain_from_xr (event->subDomain, &perf_event.sub_domain))
+    {
+      g_debug ("Event: perf settings of unknown domain %d/%d", event->domain,
+               event->subDomain);
+      return;
+    }
+
+  perf_event.from_level = _perf_notification_level_from_xr (event->fromLevel);
+  perf_event.to_level = _perf_notification_level_from_xr (event->toLevel);
+
+  g_debug ("Event: perf settings domain %d sub domain %d: %d -> %d",
+           perf_event.domain, perf_event.sub_domain, perf_event.from_level,
+           perf_event.to_level);
+
+  self->perf_levels[perf_event.domain][perf_event.sub_domain]
+    = perf_event.to_level;
+  _update_quality_scale (self);
+
+  perf_event.quality_scale = self->quality_scale;
+  g_signal_emit (self, context_signals[PERFORMANCE_EVENT], 0, &perf_event);
+}
+
+static void
+_handle_visibility_mask_changed (GxrContext        *self,
+                                 XrEventDataBuffer *runtimeEvent)
+{
+  XrEventDataVisibilityMaskChangedKHR *event
+    = (XrEventDataVisibilityMaskChangedKHR *) runtimeEvent;
+
+  g_debug ("Event: visibility mask of view %d changed", event->viewIndex);
+
+  if (!self->visibility_masks
+      || event->viewConfigurationType != self->view_config_type
+      || event->viewIndex >= self->view_count)
+    return;
+
+  gxr_visibility_mask_fetch (&self->visibility_masks[event->viewIndex],
+                             self->instance, self->session,
+                             self->view_config_type, event->viewIndex);
+  self->visibility_mask_changed = TRUE;
+}
+
+static void
+_handle_state_changed (GxrContext *self, XrEventDataBuffer *runtimeEvent)
+{
+  XrEventDataSessionStateChanged *event = (XrEventDataSessionStateChanged *)
     runtimeEvent;
 
   self->session_state = event->state;
@@ -1745,10 +2648,10 @@ gxr_context_poll_events (GxrContext *self)
             _handle_visibility_changed (self, &runtimeEvent);
             break;
           case XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT:
-            g_debug ("Event: STUB: perf settings");
+            _handle_perf_settings (self, &runtimeEvent);
             break;
           case XR_TYPE_EVENT_DATA_VISIBILITY_MASK_CHANGED_KHR:
-            g_debug ("Event: STUB: visibility mask changed");
+            _handle_visibility_mask_changed (self, &runtimeEvent);
             break;
           case XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED:
             _handle_state_changed (self, &runtimeEvent);
@@ -1780,6 +2683,60 @@ gxr_context_poll_events (GxrContext *self)
     }
 }
 
+/*
+ * The inset pair of quad views has its own swapchain size, its framebuffers
+ * are scaled like the ones of the primary pair.
+ */
+static VkExtent2D
+_get_view_pair_framebuffer_extent (GxrContext *self, uint32_t pair)
+{
+  VkExtent2D primary = self->swapchain[0][GxrSwapchainTypeColor].extent;
+  VkExtent2D swapchain = self->swapchain[pair][GxrSwapchainTypeColor].extent;
+  if (pair == 0 || primary.width == 0 || primary.height == 0)
+    return self->framebuffer_extent;
+
+  VkExtent2D extent = {
+    .width = MAX (1, (uint32_t) ((uint64_t) swapchain.width
+                                 * self->framebuffer_extent.width
+                                 / primary.width)),
+    .height = MAX (1, (uint32_t) ((uint64_t) swapchain.height
+                                  * self->framebuffer_extent.height
+                                  / primary.height)),
+  };
+  return extent;
+}
+
+static void
+_clear_visibility_mask_pipeline (GxrContext *self)
+{
+  if (self->visibility_mask_pipeline == VK_NULL_HANDLE)
+    return;
+
+  VkDevice device = gulkan_context_get_device_handle (self->gc);
+  vkDestroyPipeline (device, self->visibility_mask_pipeline, NULL);
+  vkDestroyPipelineLayout (device, self->visibility_mask_layout, NULL);
+  self->visibility_mask_pipeline = VK_NULL_HANDLE;
+  self->visibility_mask_layout = VK_NULL_HANDLE;
+}
+
+/* Without the pipeline, the visibility mask is not drawn. */
+static void
+_init_visibility_mask_pipeline (GxrContext       *self,
+                                GulkanRenderPass *render_pass)
+{
+  _clear_visibility_mask_pipeline (self);
+
+  if (!self->visibility_masks)
+    return;
+
+  VkDevice device = gulkan_context_get_device_handle (self->gc);
+  if (!gxr_visibility_mask_create_pipeline (
+        device, gulkan_render_pass_get_handle (render_pass),
+        self->framebuffer_sample_count, &self->visibility_mask_layout,
+        &self->visibility_mask_pipeline))
+    g_printerr ("Could not create visibility mask pipeline.\n");
+}
+
 gboolean
 gxr_context_init_framebuffers (GxrContext           *self,
                                VkExtent2D            extent,
@@ -1792,8 +2749,9 @@ gxr_context_init_framebuffers (GxrContext           *self,
   self->framebuffer_extent = extent;
   self->framebuffer_sample_count = sample_count;
 
-  VkFormat format = self->swapchain[GxrSwapchainTypeColor].format;
-  VkFormat depth_format = self->swapchain[GxrSwapchainTypeDepth].format;
+  /* all pairs share formats, so one render pass works for all of them */
+  VkFormat format = self->swapchain[0][GxrSwapchainTypeColor].format;
+  VkFormat depth_format = self->swapchain[0][GxrSwapchainTypeDepth].format;
   *render_pass
     = gulkan_render_pass_new_multiview (device, sample_count, format,
                                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
@@ -1804,33 +2762,31 @@ gxr_context_init_framebuffers (GxrContext           *self,
       return FALSE;
     }
 
-  g_debug ("Creating %d framebuffers",
-           self->swapchain[GxrSwapchainTypeColor].length);
+  _init_visibility_mask_pipeline (self, *render_pass);
 
-  self->framebuffers = g_malloc (sizeof (GulkanFrameBuffer *)
-                                 * self->swapchain[GxrSwapchainTypeColor]
-                                     .length);
-  for (uint32_t i = 0; i < self->swapchain[GxrSwapchainTypeColor].length; i++)
+  for (uint32_t p = 0; p < self->view_pair_count; p++)
     {
-      VkImage color_image = self->swapchain[GxrSwapchainTypeColor]
-                              .images[i]
-                              .image;
-      VkImage depth_image = self->swapchain[GxrSwapchainTypeDepth]
-                              .images[i]
-                              .image;
+      struct GxrSwapchain *color = &self->swapchain[p][GxrSwapchainTypeColor];
+      struct GxrSwapchain *depth = &self->swapchain[p][GxrSwapchainTypeDepth];
+      VkExtent2D pair_extent = _get_view_pair_framebuffer_extent (self, p);
 
-      self->framebuffers[i]
-        = gulkan_frame_buffer_new_from_image_with_depth (device, *render_pass,
-                                                         color_image, extent,
-                                                         sample_count, format,
-                                                         self->view_count,
-                                                         depth_image,
-                                                         depth_format);
+      g_debug ("Creating %d framebuffers for view pair %d", color->length, p);
 
-      if (!GULKAN_IS_FRAME_BUFFER (self->framebuffers[i]))
+      self->framebuffers[p] = g_malloc0 (sizeof (GulkanFrameBuffer *)
+                                         * color->length);
+      for (uint32_t i = 0; i < color->length; i++)
         {
-          g_printerr ("Could not initialize frambuffer.");
-          return FALSE;
+          self->framebuffers[p][i]
+            = gulkan_frame_buffer_new_from_image_with_depth (
+              device, *render_pass, color->images[i].image, pair_extent,
+              sample_count, format, color->array_size, depth->images[i].image,
+              depth_format);
+
+          if (!GULKAN_IS_FRAME_BUFFER (self->framebuffers[p][i]))
+            {
+              g_printerr ("Could not initialize frambuffer.");
+              return FALSE;
+            }
         }
     }
 
@@ -1838,78 +2794,487 @@ gxr_context_init_framebuffers (GxrContext           *self,
 }
 
 static void
-_get_projection_matrix_from_fov (const XrFovf       fov,
-                                 const float        near_z,
-                                 const float        far_z,
-                                 graphene_matrix_t *mat)
+_cleanup_frame_resources (GxrContext *self)
 {
-  const float tan_left = tanf (fov.angleLeft);
-  const float tan_right = tanf (fov.angleRight);
-
-  const float tan_down = tanf (fov.angleDown);
-  const float tan_up = tanf (fov.angleUp);
-
-  const float tan_width = tan_right - tan_left;
-  const float tan_height = tan_up - tan_down;
-
-  const float a11 = 2 / tan_width;
-  const float a22 = 2 / tan_height;
-
-  const float a31 = (tan_right + tan_left) / tan_width;
-  const float a32 = (tan_up + tan_down) / tan_height;
-  const float a33 = -far_z / (far_z - near_z);
-
-  const float a43 = -(far_z * near_z) / (far_z - near_z);
+  if (!self->frame_resources)
+    return;
 
-  const float m[16] = {
-    a11, 0, 0, 0, 0, a22, 0, 0, a31, a32, a33, -1, 0, 0, a43, 0,
-  };
-
-  graphene_matrix_init_from_float (mat, m);
-}
+  VkDevice device = gulkan_context_get_device_handle (self->gc);
 
-void
-gxr_context_get_projection (GxrContext        *self,
-                            GxrEye             eye,
-                            float              near,
-                            float              far,
-                            graphene_matrix_t *mat)
-{
-  if (self->views == NULL)
+  for (uint32_t i = 0; i < self->frame_resource_count; i++)
     {
-      g_warning ("get_projection needs to be called "
-                 "between begin and end frame.\n");
-      graphene_matrix_init_identity (mat);
-      return;
+      struct GxrFrameResource *res = &self->frame_resources[i];
+      if (res->fence == VK_NULL_HANDLE)
+        continue;
+      if (res->pending)
+        vkWaitForFences (device, 1, &res->fence, VK_TRUE, UINT64_MAX);
+      vkDestroyFence (device, res->fence, NULL);
     }
-  _get_projection_matrix_from_fov (self->views[eye].fov, near, far, mat);
+
+  if (self->frame_command_pool != VK_NULL_HANDLE)
+    vkDestroyCommandPool (device, self->frame_command_pool, NULL);
+
+  self->frame_command_pool = VK_NULL_HANDLE;
+  g_clear_pointer (&self->frame_resources, g_free);
+  self->frame_resource_count = 0;
+  self->recording_frame_resource = NULL;
 }
 
-static void
-_get_view_matrix_from_pose (XrPosef *pose, graphene_matrix_t *mat)
+/*
+ * Creates a fence and a reusable command buffer for each swapchain image.
+ * Commands recorded with gxr_context_begin_frame_commands are submitted
+ * without waiting for the GPU, so up to max_frames_in_flight frames are
+ * rendered while the CPU prepares the next ones.
+ */
+gboolean
+gxr_context_init_frame_resources (GxrContext *self,
+                                  uint32_t    max_frames_in_flight)
 {
-  graphene_quaternion_t q;
-  graphene_quaternion_init (&q, pose->orientation.x, pose->orientation.y,
-                            pose->orientation.z, pose->orientation.w);
+  _cleanup_frame_resources (self);
 
-  graphene_matrix_t rotation;
-  graphene_matrix_init_identity (&rotation);
-  graphene_matrix_rotate_quaternion (&rotation, &q);
+  GulkanDevice *gulkan_device = gulkan_context_get_device (self->gc);
+  GulkanQueue  *queue = gulkan_device_get_graphics_queue (gulkan_device);
+  VkDevice      device = gulkan_device_get_handle (gulkan_device);
 
-  graphene_point3d_t position = {
-    pose->position.x,
-    pose->position.y,
-    pose->position.z,
+  VkCommandPoolCreateInfo pool_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+    .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+    .queueFamilyIndex = gulkan_queue_get_family_index (queue),
   };
+  VkResult res = vkCreateCommandPool (device, &pool_info, NULL,
+                                      &self->frame_command_pool);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not create frame command pool: %d\n", res);
+      return FALSE;
+    }
 
-  graphene_matrix_t translation;
-  graphene_matrix_init_translate (&translation, &position);
+  uint32_t count = self->swapchain[0][GxrSwapchainTypeColor].length;
+  self->frame_resources = g_new0 (struct GxrFrameResource, count);
+  self->frame_resource_count = count;
+  self->max_frames_in_flight = CLAMP (max_frames_in_flight, 1, count);
 
-  graphene_matrix_t view;
-  graphene_matrix_multiply (&rotation, &translation, &view);
+  for (uint32_t i = 0; i < count; i++)
+    {
+      struct GxrFrameResource *frame_resource = &self->frame_resources[i];
 
-  graphene_matrix_inverse (&view, mat);
-}
+      VkCommandBufferAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = self->frame_command_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+      };
+      res = vkAllocateCommandBuffers (device, &alloc_info,
+                                      &frame_resource->cmd_buffer);
+      if (res != VK_SUCCESS)
+        {
+          g_printerr ("Could not allocate frame command buffer: %d\n", res);
+          _cleanup_frame_resources (self);
+          return FALSE;
+        }
+
+      VkFenceCreateInfo fence_info = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+      };
+      res = vkCreateFence (device, &fence_info, NULL, &frame_resource->fence);
+      if (res != VK_SUCCESS)
+        {
+          g_printerr ("Could not create frame fence: %d\n", res);
+          _cleanup_frame_resources (self);
+          return FALSE;
+        }
+    }
+
+  g_debug ("Created frame resources for %d images, %d frames in flight",
+           count, self->max_frames_in_flight);
+
+  return TRUE;
+}
+
+static void
+_free_retired_mesh (gpointer data)
+{
+  struct GxrRetiredMesh *retired = data;
+  g_object_unref (retired->mesh);
+  g_free (retired);
+}
+
+/* Frees retired meshes once no frame that may draw them is pending. */
+static void
+_free_completed_meshes (GxrContext *self)
+{
+  uint64_t oldest_pending = G_MAXUINT64;
+  for (uint32_t i = 0; i < self->frame_resource_count; i++)
+    {
+      struct GxrFrameResource *res = &self->frame_resources[i];
+      if (res->pending)
+        oldest_pending = MIN (oldest_pending, res->serial);
+    }
+
+  GSList *l = self->retired_visibility_mask_meshes;
+  while (l)
+    {
+      GSList                *next = l->next;
+      struct GxrRetiredMesh *retired = l->data;
+      if (retired->serial <= self->frame_serial
+          && retired->serial < oldest_pending)
+        {
+          _free_retired_mesh (retired);
+          self->retired_visibility_mask_meshes
+            = g_slist_delete_link (self->retired_visibility_mask_meshes, l);
+        }
+      l = next;
+    }
+}
+
+static void
+_wait_frame_resource (VkDevice device, struct GxrFrameResource *res)
+{
+  if (!res->pending)
+    return;
+
+  vkWaitForFences (device, 1, &res->fence, VK_TRUE, UINT64_MAX);
+  res->pending = FALSE;
+}
+
+/* Waits for the oldest frames until less than the maximum are in flight. */
+static void
+_limit_frames_in_flight (GxrContext *self, VkDevice device)
+{
+  while (TRUE)
+    {
+      struct GxrFrameResource *oldest = NULL;
+      uint32_t                 in_flight = 0;
+
+      for (uint32_t i = 0; i < self->frame_resource_count; i++)
+        {
+          struct GxrFrameResource *res = &self->frame_resources[i];
+          if (res->pending && vkGetFenceStatus (device, res->fence)
+                                == VK_SUCCESS)
+            res->pending = FALSE;
+
+          if (!res->pending)
+            continue;
+
+          in_flight++;
+          if (!oldest || res->serial < oldest->serial)
+            oldest = res;
+        }
+
+      if (in_flight < self->max_frames_in_flight)
+        return;
+
+      _wait_frame_resource (device, oldest);
+    }
+}
+
+/*
+ * Returns the command buffer of the acquired swapchain image in recording
+ * state, after the GPU finished the previous frame that used it.
+ */
+VkCommandBuffer
+gxr_context_begin_frame_commands (GxrContext *self)
+{
+  if (!self->frame_resources)
+    {
+      g_printerr ("Frame resources were not initialized.\n");
+      return VK_NULL_HANDLE;
+    }
+
+  VkDevice device = gulkan_context_get_device_handle (self->gc);
+
+  uint32_t                 index = self->swapchain[0][GxrSwapchainTypeColor]
+                                   .buffer_index;
+  struct GxrFrameResource *frame_resource = &self->frame_resources[index];
+
+  _wait_frame_resource (device, frame_resource);
+  _limit_frames_in_flight (self, device);
+  _free_completed_meshes (self);
+
+  vkResetFences (device, 1, &frame_resource->fence);
+  vkResetCommandBuffer (frame_resource->cmd_buffer, 0);
+
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  VkResult res = vkBeginCommandBuffer (frame_resource->cmd_buffer,
+                                       &begin_info);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not begin frame command buffer: %d\n", res);
+      return VK_NULL_HANDLE;
+    }
+
+  self->recording_frame_resource = frame_resource;
+
+  return frame_resource->cmd_buffer;
+}
+
+/* Submits the recorded commands without waiting for them to complete. */
+gboolean
+gxr_context_submit_frame_commands (GxrContext *self)
+{
+  struct GxrFrameResource *frame_resource = self->recording_frame_resource;
+  if (!frame_resource)
+    {
+      g_printerr ("No frame commands are being recorded.\n");
+      return FALSE;
+    }
+  self->recording_frame_resource = NULL;
+
+  VkResult res = vkEndCommandBuffer (frame_resource->cmd_buffer);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not end frame command buffer: %d\n", res);
+      return FALSE;
+    }
+
+  GulkanDevice *device = gulkan_context_get_device (self->gc);
+  GulkanQueue  *queue = gulkan_device_get_graphics_queue (device);
+
+  VkSubmitInfo submit_info = {
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &frame_resource->cmd_buffer,
+  };
+
+  GMutex *mutex = gulkan_queue_get_pool_mutex (queue);
+  g_mutex_lock (mutex);
+  res = vkQueueSubmit (gulkan_queue_get_handle (queue), 1, &submit_info,
+                       frame_resource->fence);
+  g_mutex_unlock (mutex);
+
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not submit frame commands: %d\n", res);
+      return FALSE;
+    }
+
+  frame_resource->serial = ++self->frame_serial;
+  frame_resource->pending = TRUE;
+
+  return TRUE;
+}
+
+static void
+_get_projection_matrix_from_fov (const XrFovf       fov,
+                                 const float        near_z,
+                                 const float        far_z,
+                                 graphene_matrix_t *mat)
+{
+  const float tan_left = tanf (fov.angleLeft);
+  const float tan_right = tanf (fov.angleRight);
+
+  const float tan_down = tanf (fov.angleDown);
+  const float tan_up = tanf (fov.angleUp);
+
+  const float tan_width = tan_right - tan_left;
+  const float tan_height = tan_up - tan_down;
+
+  const float a11 = 2 / tan_width;
+  const float a22 = 2 / tan_height;
+
+  const float a31 = (tan_right + tan_left) / tan_width;
+  const float a32 = (tan_up + tan_down) / tan_height;
+  const float a33 = -far_z / (far_z - near_z);
+
+  const float a43 = -(far_z * near_z) / (far_z - near_z);
+
+  const float m[16] = {
+    a11, 0, 0, 0, 0, a22, 0, 0, a31, a32, a33, -1, 0, 0, a43, 0,
+  };
+
+  graphene_matrix_init_from_float (mat, m);
+}
+
+static gboolean
+_fov_changed (const XrFovf *a, const XrFovf *b)
+{
+  const float e = VISIBILITY_MASK_FOV_EPSILON;
+  return fabsf (a->angleLeft - b->angleLeft) > e
+         || fabsf (a->angleRight - b->angleRight) > e
+         || fabsf (a->angleUp - b->angleUp) > e
+         || fabsf (a->angleDown - b->angleDown) > e;
+}
+
+static gboolean
+_needs_visibility_mask_update (GxrContext *self)
+{
+  if (self->visibility_mask_changed)
+    return TRUE;
+
+  for (uint32_t i = 0; i < self->view_count; i++)
+    if (_fov_changed (&self->views[i].fov, &self->visibility_mask_fovs[i]))
+      return TRUE;
+
+  return FALSE;
+}
+
+static void
+_update_visibility_mask_mesh (GxrContext *self)
+{
+  uint32_t max_vertex_count = 0;
+  for (uint32_t i = 0; i < self->view_count; i++)
+    max_vertex_count += self->visibility_masks[i].index_count;
+
+  float *vertices = g_new (float, (gsize) max_vertex_count
+                                    * GXR_VISIBILITY_MASK_VERTEX_SIZE);
+
+  uint32_t vertex_count = 0;
+  uint32_t pair_vertex_counts[MAX_VIEW_PAIRS] = {0};
+  for (uint32_t i = 0; i < self->view_count; i++)
+    {
+      float   *view_vertices = &vertices[vertex_count
+                                       * GXR_VISIBILITY_MASK_VERTEX_SIZE];
+      uint32_t count
+        = gxr_visibility_mask_write_mesh (&self->visibility_masks[i],
+                                          self->views[i].fov,
+                                          i % VIEW_PAIR_SIZE, view_vertices);
+      vertex_count += count;
+      pair_vertex_counts[i / VIEW_PAIR_SIZE] += count;
+      self->visibility_mask_fovs[i] = self->views[i].fov;
+    }
+
+  GulkanDevice *device = gulkan_context_get_device (self->gc);
+
+  /*
+   * Frames in flight and the one being recorded may still draw the old
+   * mesh, so it is freed once their fences signaled. Without frame
+   * resources there is no fence to wait for, so the device is waited for.
+   */
+  if (self->visibility_mask_mesh && self->frame_resources)
+    {
+      struct GxrRetiredMesh *retired = g_new (struct GxrRetiredMesh, 1);
+      retired->mesh = g_steal_pointer (&self->visibility_mask_mesh);
+      retired->serial = self->frame_serial + 1;
+      self->retired_visibility_mask_meshes
+        = g_slist_prepend (self->retired_visibility_mask_meshes, retired);
+    }
+  else if (self->visibility_mask_mesh)
+    {
+      vkDeviceWaitIdle (gulkan_device_get_handle (device));
+      g_clear_object (&self->visibility_mask_mesh);
+    }
+
+  for (uint32_t i = 0; i < MAX_VIEW_PAIRS; i++)
+    self->visibility_mask_vertex_counts[i] = pair_vertex_counts[i];
+  self->visibility_mask_changed = FALSE;
+
+  if (vertex_count > 0)
+    {
+      GulkanVertexBuffer *mesh
+        = gulkan_vertex_buffer_new (device,
+                                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+      gulkan_vertex_buffer_add_attribute (mesh,
+                                          GXR_VISIBILITY_MASK_VERTEX_SIZE,
+                                          sizeof (float) * vertex_count
+                                            * GXR_VISIBILITY_MASK_VERTEX_SIZE,
+                                          0, (uint8_t *) vertices);
+      if (gulkan_vertex_buffer_upload (mesh))
+        self->visibility_mask_mesh = mesh;
+      else
+        {
+          g_printerr ("Could not upload visibility mask mesh.\n");
+          g_object_unref (mesh);
+        }
+    }
+
+  g_free (vertices);
+}
+
+/*
+ * Returns a mesh of the hidden area of all views, or NULL if the runtime
+ * provides none. It is a triangle list with one vec4 attribute: x and y in
+ * normalized device coordinates of gxr_context_get_projection, the depth
+ * of the near plane and the index of the view the vertex belongs to in its
+ * view pair. A multiview vertex shader moves vertices of other views out of
+ * clip space.
+ * The mesh follows mask changes and the field of view of the frame, so it
+ * needs to be requested between begin and end frame.
+ */
+GulkanVertexBuffer *
+gxr_context_get_visibility_mask_mesh (GxrContext *self)
+{
+  if (!self->visibility_masks || !self->views)
+    return NULL;
+
+  if (self->have_valid_pose && _needs_visibility_mask_update (self))
+    _update_visibility_mask_mesh (self);
+
+  return self->visibility_mask_mesh;
+}
+
+/*
+ * Draws the hidden area mesh of a view pair at the start of its render pass
+ * from gxr_context_init_framebuffers. It binds a depth only pipeline and sets
+ * the viewport to the render extent, flipped like gulkan pipelines with
+ * flip_y, so the app binds its own pipeline afterwards. With the depth
+ * cleared to 1.0 and a less depth test, the fragments of the scene in the
+ * lens corners are rejected before shading.
+ * Returns FALSE if there is no mask to draw.
+ */
+gboolean
+gxr_context_record_visibility_mask (GxrContext     *self,
+                                    VkCommandBuffer cmd_buffer,
+                                    uint32_t        pair)
+{
+  if (self->visibility_mask_pipeline == VK_NULL_HANDLE)
+    return FALSE;
+
+  GulkanVertexBuffer *mesh = gxr_context_get_visibility_mask_mesh (self);
+  if (!mesh || pair >= self->view_pair_count
+      || self->visibility_mask_vertex_counts[pair] == 0)
+    return FALSE;
+
+  uint32_t first_vertex = 0;
+  for (uint32_t i = 0; i < pair; i++)
+    first_vertex += self->visibility_mask_vertex_counts[i];
+
+  VkExtent2D extent = gxr_context_get_render_extent (self,
+                                                     pair * VIEW_PAIR_SIZE);
+  VkViewport viewport = {
+    .y = (float) extent.height,
+    .width = (float) extent.width,
+    .height = -(float) extent.height,
+    .maxDepth = 1.0f,
+  };
+  VkRect2D scissor = {
+    .extent = extent,
+  };
+
+  vkCmdBindPipeline (cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                     self->visibility_mask_pipeline);
+  vkCmdSetViewport (cmd_buffer, 0, 1, &viewport);
+  vkCmdSetScissor (cmd_buffer, 0, 1, &scissor);
+  gulkan_vertex_buffer_bind_with_offsets (mesh, cmd_buffer);
+  vkCmdDraw (cmd_buffer, self->visibility_mask_vertex_counts[pair], 1,
+             first_vertex, 0);
+
+  return TRUE;
+}
+
+void
+gxr_context_get_projection (GxrContext        *self,
+                            GxrEye             eye,
+                            float              near,
+                            float              far,
+                            graphene_matrix_t *mat)
+{
+  if (self->views == NULL)
+    {
+      g_warning ("get_projection needs to be called "
+                 "between begin and end frame.\n");
+      graphene_matrix_init_identity (mat);
+      return;
+    }
+  if (!_has_view (self, eye))
+    {
+      graphene_matrix_init_identity (mat);
+      return;
+    }
+  _get_projection_matrix_from_fov (self->views[eye].fov, near, far, mat);
+}
 
 void
 gxr_context_get_view (GxrContext *self, GxrEye eye, graphene_matrix_t *mat)
@@ -1920,12 +3285,25 @@ gxr_context_get_view (GxrContext *self, GxrEye eye, graphene_matrix_t *mat)
       graphene_matrix_init_identity (mat);
       return;
     }
-  _get_view_matrix_from_pose (&self->views[eye].pose, mat);
+  if (!_has_view (self, eye))
+    {
+      graphene_matrix_init_identity (mat);
+      return;
+    }
+  GxrRigidPose pose;
+  gxr_rigid_pose_init_from_xr (&pose, &self->views[eye].pose);
+  gxr_rigid_pose_inverse (&pose, &pose);
+  gxr_rigid_pose_to_matrix (&pose, mat);
 }
 
 void
 gxr_context_get_eye_position (GxrContext *self, GxrEye eye, graphene_vec3_t *v)
 {
+  if (self->views == NULL || !_has_view (self, eye))
+    {
+      graphene_vec3_init_from_vec3 (v, graphene_vec3_zero ());
+      return;
+    }
   graphene_vec3_init (v, self->views[eye].pose.position.x,
                       self->views[eye].pose.position.y,
                       self->views[eye].pose.position.z);
@@ -1962,155 +3340,1279 @@ _acquire_and_wait (GxrContext *self, struct GxrSwapchain *swapchain)
   if (!_check_xr_result (result, "failed to wait for swapchain image!"))
     return FALSE;
 
+  swapchain->acquired = TRUE;
+
   return TRUE;
 }
 
-gboolean
-gxr_context_wait_frame (GxrContext *self)
+static void
+_wait_frame (GxrContext *self, struct GxrWaitedFrame *frame)
 {
-  XrResult result;
-
   XrFrameState frame_state = {
     .type = XR_TYPE_FRAME_STATE,
   };
   XrFrameWaitInfo frameWaitInfo = {
     .type = XR_TYPE_FRAME_WAIT_INFO,
   };
-  result = xrWaitFrame (self->session, &frameWaitInfo, &frame_state);
-  if (!_check_xr_result (result,
-                         "xrWaitFrame() was not successful, exiting..."))
-    return FALSE;
+  frame->result = xrWaitFrame (self->session, &frameWaitInfo, &frame_state);
+  frame->predicted_display_time = frame_state.predictedDisplayTime;
+  frame->predicted_display_period = frame_state.predictedDisplayPeriod;
+  frame->should_render = frame_state.shouldRender == XR_TRUE;
+  frame->returned = g_get_monotonic_time ();
+}
+
+static gpointer
+_frame_thread_func (gpointer data)
+{
+  GxrContext *self = data;
 
-  if (!_acquire_and_wait (self, &self->swapchain[GxrSwapchainTypeColor]))
+  if (self->frame_thread_config)
     {
-      g_printerr ("Failed to acquire color image");
-      return FALSE;
+      GxrThreadScheduling scheduling
+        = gxr_thread_scheduling_apply (self->frame_thread_config);
+      g_atomic_int_set (&self->thread_scheduling[GXR_THREAD_FRAME],
+                        scheduling);
     }
 
-  if (!_acquire_and_wait (self, &self->swapchain[GxrSwapchainTypeDepth]))
+  while (GPOINTER_TO_INT (g_async_queue_pop (self->frame_requests))
+         == GxrFrameRequestWait)
     {
-      g_printerr ("Failed to acquire depth image");
-      return FALSE;
+      struct GxrWaitedFrame *frame = g_new (struct GxrWaitedFrame, 1);
+      _wait_frame (self, frame);
+      g_async_queue_push (self->waited_frames, frame);
+
+      g_mutex_lock (&self->frame_source_mutex);
+      if (self->frame_source && !g_source_is_destroyed (self->frame_source))
+        g_source_set_ready_time (self->frame_source, 0);
+      g_mutex_unlock (&self->frame_source_mutex);
     }
 
-  g_mutex_lock (&self->wait_frame_mutex);
+  return NULL;
+}
+
+static void
+_request_frame (GxrContext *self)
+{
+  g_async_queue_push (self->frame_requests,
+                      GINT_TO_POINTER (GxrFrameRequestWait));
+  self->frame_requested = TRUE;
+}
 
-  if (!self->should_render && frame_state.shouldRender)
-    {
-      GxrStateChangeEvent state_change_event = {
-        .state_change = GXR_STATE_RENDERING_START,
-      };
-      g_debug ("Event: start rendering");
-      g_signal_emit (self, context_signals[STATE_CHANGE_EVENT], 0,
-                     &state_change_event);
-    }
-  else if (self->should_render && !frame_state.shouldRender)
+static void
+_stop_frame_thread (GxrContext *self)
+{
+  g_async_queue_push (self->frame_requests,
+                      GINT_TO_POINTER (GxrFrameRequestStop));
+  g_thread_join (self->frame_thread);
+  self->frame_thread = NULL;
+
+  /* A waited frame has to be begun before the next xrWaitFrame call */
+  if (!self->pending_frame)
+    self->pending_frame = g_async_queue_try_pop (self->waited_frames);
+
+  g_clear_pointer (&self->frame_requests, g_async_queue_unref);
+  g_clear_pointer (&self->waited_frames, g_async_queue_unref);
+  self->frame_requested = FALSE;
+}
+
+gboolean
+gxr_context_set_pipelined (GxrContext *self, gboolean pipelined)
+{
+  if (pipelined == (self->frame_thread != NULL))
+    return TRUE;
+
+  if (!pipelined)
     {
-      GxrStateChangeEvent state_change_event = {
-        .state_change = GXR_STATE_RENDERING_STOP,
-      };
-      g_debug ("Event: stop rendering");
-      g_signal_emit (self, context_signals[STATE_CHANGE_EVENT], 0,
-                     &state_change_event);
+      _stop_frame_thread (self);
+      g_debug ("Pipelined frame loop disabled");
+      return TRUE;
     }
 
-  self->should_render = frame_state.shouldRender == XR_TRUE;
+  self->frame_requests = g_async_queue_new ();
+  self->waited_frames = g_async_queue_new_full (g_free);
+  self->frame_requested = FALSE;
 
-  self->predicted_display_time = frame_state.predictedDisplayTime;
-  self->predicted_display_period = frame_state.predictedDisplayPeriod;
-
-  g_mutex_unlock (&self->wait_frame_mutex);
+  GError *error = NULL;
+  self->frame_thread = g_thread_try_new ("gxr-frame", _frame_thread_func, self,
+                                         &error);
+  if (!self->frame_thread)
+    {
+      g_printerr ("Could not start frame thread: %s\n", error->message);
+      g_error_free (error);
+      g_clear_pointer (&self->frame_requests, g_async_queue_unref);
+      g_clear_pointer (&self->waited_frames, g_async_queue_unref);
+      return FALSE;
+    }
 
+  g_debug ("Pipelined frame loop enabled");
   return TRUE;
 }
 
+gboolean
+gxr_context_is_pipelined (GxrContext *self)
+{
+  return self->frame_thread != NULL;
+}
+
+/*
+ * The render thread is configured right away. The frame thread is
+ * configured when it starts, so it is restarted if it already runs.
+ * Input is polled on the thread dispatching the frame source, which is
+ * configured with GXR_THREAD_RENDER, since actions emit their signals on the
+ * thread that syncs them.
+ */
+void
+gxr_context_set_thread_scheduling (GxrContext            *self,
+                                   GxrThreadRole          role,
+                                   const GxrThreadConfig *config)
+{
+  if (role == GXR_THREAD_RENDER)
+    {
+      GxrThreadScheduling scheduling = gxr_thread_scheduling_apply (config);
+      g_atomic_int_set (&self->thread_scheduling[role], scheduling);
+      return;
+    }
+
+  gboolean pipelined = gxr_context_is_pipelined (self);
+  gxr_context_set_pipelined (self, FALSE);
+
+  g_free (self->frame_thread_config);
+  self->frame_thread_config = g_new (GxrThreadConfig, 1);
+  *self->frame_thread_config = *config;
+
+  gxr_context_set_pipelined (self, pipelined);
+}
+
+GxrThreadScheduling
+gxr_context_get_thread_scheduling (GxrContext *self, GxrThreadRole role)
+{
+  return (GxrThreadScheduling) g_atomic_int_get (
+    &self->thread_scheduling[role]);
+}
+
+static void
+_next_waited_frame (GxrContext *self, struct GxrWaitedFrame *frame)
+{
+  if (self->pending_frame)
+    {
+      *frame = *self->pending_frame;
+      g_clear_pointer (&self->pending_frame, g_free);
+      return;
+    }
+
+  if (!self->frame_thread)
+    {
+      _wait_frame (self, frame);
+      return;
+    }
+
+  if (!self->frame_requested)
+    _request_frame (self);
+
+  struct GxrWaitedFrame *waited = g_async_queue_pop (self->waited_frames);
+  self->frame_requested = FALSE;
+  *frame = *waited;
+  g_free (waited);
+}
+
+gboolean
+gxr_context_wait_frame (GxrContext *self)
+{
+  self->frame_timestamps = (GxrFrameTimestamps){
+    .wait_start = g_get_monotonic_time (),
+  };
+
+  struct GxrWaitedFrame frame;
+  _next_waited_frame (self, &frame);
+
+  self->frame_timestamps.wait_end = g_get_monotonic_time ();
+
+  /* the frame is due one period after the runtime released it */
+  self->frame_deadline = frame.returned
+                         + frame.predicted_display_period / NSEC_PER_USEC;
+  self->frame_start_pending = TRUE;
+
+  self->frame_reuse_requested = FALSE;
+  self->frame_reused = FALSE;
+
+  if (!_check_xr_result (frame.result,
+                         "xrWaitFrame() was not successful, exiting..."))
+    return FALSE;
+
+  self->frame_unbegun = TRUE;
+
+  if (!self->should_render && frame.should_render)
+    {
+      GxrStateChangeEvent state_change_event = {
+        .state_change = GXR_STATE_RENDERING_START,
+      };
+      g_debug ("Event: start rendering");
+      g_signal_emit (self, context_signals[STATE_CHANGE_EVENT], 0,
+                     &state_change_event);
+    }
+  else if (self->should_render && !frame.should_render)
+    {
+      GxrStateChangeEvent state_change_event = {
+        .state_change = GXR_STATE_RENDERING_STOP,
+      };
+      g_debug ("Event: stop rendering");
+      g_signal_emit (self, context_signals[STATE_CHANGE_EVENT], 0,
+                     &state_change_event);
+    }
+
+  self->should_render = frame.should_render;
+
+  self->predicted_display_time = frame.predicted_display_time;
+  self->predicted_display_period = frame.predicted_display_period;
+  gxr_space_cache_set_time (&self->space_cache, self->predicted_display_time);
+  _publish_poses (self);
+
+  return TRUE;
+}
+
+static gboolean
+_locate_views (GxrContext *self, XrView *views, XrViewState *view_state)
+{
+  XrViewLocateInfo viewLocateInfo = {
+    .type = XR_TYPE_VIEW_LOCATE_INFO,
+    .displayTime = self->predicted_display_time,
+    .space = self->play_space,
+    .viewConfigurationType = self->view_config_type,
+  };
+
+  *view_state = (XrViewState){
+    .type = XR_TYPE_VIEW_STATE,
+  };
+  uint32_t viewCountOutput;
+  XrResult result = xrLocateViews (self->session, &viewLocateInfo, view_state,
+                                   self->view_count, &viewCountOutput, views);
+  return _check_xr_result (result, "Could not locate views");
+}
+
+static gboolean
+_release_swapchain (GxrContext *self, struct GxrSwapchain *swapchain)
+{
+  (void) self;
+
+  if (!swapchain->acquired)
+    return TRUE;
+
+  swapchain->acquired = FALSE;
+
+  XrSwapchainImageReleaseInfo swapchainImageReleaseInfo = {
+    .type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO,
+  };
+  XrResult result = xrReleaseSwapchainImage (swapchain->handle,
+                                             &swapchainImageReleaseInfo);
+  if (!_check_xr_result (result, "failed to release swapchain image!"))
+    return FALSE;
+
+  return TRUE;
+}
+
+/*
+ * Ends a begun frame without layers. A frame that was waited for has to be
+ * begun and ended, or the next xrWaitFrame blocks.
+ */
+static void
+_abandon_frame (GxrContext *self)
+{
+  for (uint32_t i = 0; i < self->view_pair_count; i++)
+    for (uint32_t j = 0; j < GxrSwapchainTypeLast; j++)
+      _release_swapchain (self, &self->swapchain[i][j]);
+
+  XrFrameEndInfo frame_end_info = {
+    .type = XR_TYPE_FRAME_END_INFO,
+    .displayTime = self->predicted_display_time,
+    .layerCount = 0,
+    .environmentBlendMode = self->blend_mode,
+  };
+  XrResult result = xrEndFrame (self->session, &frame_end_info);
+  _check_xr_result (result, "failed to abandon frame!");
+}
+
+/* Consumes a waited frame that will not be rendered. */
+static void
+_skip_frame (GxrContext *self)
+{
+  XrFrameBeginInfo frame_begin_info = {
+    .type = XR_TYPE_FRAME_BEGIN_INFO,
+  };
+  self->frame_unbegun = FALSE;
+  XrResult result = xrBeginFrame (self->session, &frame_begin_info);
+  if (_check_xr_result (result, "failed to begin skipped frame!"))
+    _abandon_frame (self);
+}
+
+static gboolean
+_begin_frame (GxrContext *self)
+{
+  if (!self->session_running)
+    {
+      g_printerr ("Can't begin frame with no session running\n");
+      return FALSE;
+    }
+
+  if (self->session_state == XR_SESSION_STATE_EXITING
+      || self->session_state == XR_SESSION_STATE_LOSS_PENDING
+      || self->session_state == XR_SESSION_STATE_STOPPING)
+    {
+      _skip_frame (self);
+      return FALSE;
+    }
+
+  XrResult result;
+
+  // --- Create projection matrices and view matrices for each eye
+  XrViewState viewState;
+  if (!_locate_views (self, self->views, &viewState))
+    {
+      _skip_frame (self);
+      return FALSE;
+    }
+
+  // --- Begin frame
+  XrFrameBeginInfo frameBeginInfo = {
+    .type = XR_TYPE_FRAME_BEGIN_INFO,
+  };
+
+  self->frame_unbegun = FALSE;
+  result = xrBeginFrame (self->session, &frameBeginInfo);
+  if (!_check_xr_result (result, "failed to begin frame!"))
+    return FALSE;
+
+  /* the frame thread can wait for the next frame while this one renders */
+  if (self->frame_thread)
+    _request_frame (self);
+
+  self->have_valid_pose = (viewState.viewStateFlags
+                           & XR_VIEW_STATE_ORIENTATION_VALID_BIT)
+                            != 0
+                          && (viewState.viewStateFlags
+                              & XR_VIEW_STATE_POSITION_VALID_BIT)
+                               != 0;
+
+  return TRUE;
+}
+
+static void
+_get_pose_delta (const XrPosef *from,
+                 const XrPosef *to,
+                 float         *angle,
+                 float         *distance)
+{
+  const XrQuaternionf *a = &from->orientation;
+  const XrQuaternionf *b = &to->orientation;
+
+  float dot = a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
+  dot = fminf (fabsf (dot), 1.0f);
+  *angle = RAD_TO_DEG (2.0f * acosf (dot));
+
+  float dx = to->position.x - from->position.x;
+  float dy = to->position.y - from->position.y;
+  float dz = to->position.z - from->position.z;
+  *distance = sqrtf (dx * dx + dy * dy + dz * dz);
+}
+
+void
+gxr_context_set_frame_start_scheduling (GxrContext *self, gboolean enabled)
+{
+  self->frame_start_scheduling = enabled;
+  self->frame_start_margin = FRAME_START_MARGIN_INITIAL;
+  self->frames_since_miss = 0;
+}
+
+/*
+ * Reports the GPU time of the last completed frame in microseconds, usually
+ * read back from timestamp queries once its fence signaled. It may arrive
+ * after the frame ended, so it is recorded with the next frame that ends.
+ */
+void
+gxr_context_report_gpu_time (GxrContext *self, int64_t gpu_time)
+{
+  self->last_gpu_duration = gpu_time;
+}
+
+/*
+ * Latest time a frame with the given deadline can start, predicted from the
+ * recent CPU and GPU durations. Frames only start late with just in time
+ * scheduling, otherwise 0 is returned.
+ */
+static int64_t
+_get_latest_frame_start (GxrContext *self, int64_t deadline)
+{
+  if (!self->frame_start_scheduling
+      || self->frame_history.count < FRAME_START_MIN_HISTORY)
+    return 0;
+
+  int64_t cpu = gxr_frame_history_get_work_percentile (&self->frame_history,
+                                                       0.9f);
+  int64_t gpu = gxr_frame_history_get_percentile (&self->frame_history,
+                                                  GXR_FRAME_PHASE_GPU, 0.9f);
+
+  return deadline - cpu - gpu - self->frame_start_margin;
+}
+
+/*
+ * Sleeps until the latest time the frame can start and still make its
+ * deadline. gxr_context_begin_frame calls this, applications that sample
+ * input should call it before syncing actions so the input is as fresh as
+ * the view poses.
+ */
+void
+gxr_context_sleep_until_frame_start (GxrContext *self)
+{
+  if (!self->frame_start_scheduling || !self->frame_start_pending)
+    return;
+
+  self->frame_start_pending = FALSE;
+
+  int64_t start = _get_latest_frame_start (self, self->frame_deadline);
+  int64_t now = g_get_monotonic_time ();
+  if (start > now)
+    g_usleep ((gulong) (start - now));
+}
+
+static void
+_update_frame_start_margin (GxrContext *self, uint32_t missed)
+{
+  int64_t period = self->predicted_display_period / NSEC_PER_USEC;
+
+  if (missed > 0)
+    {
+      self->frames_since_miss = 0;
+      self->frame_start_margin = MIN (self->frame_start_margin * 3 / 2
+                                        + FRAME_START_MARGIN_STEP,
+                                      period / 2);
+      g_debug ("Missed frame, frame start margin is now %" G_GINT64_FORMAT
+               " us",
+               self->frame_start_margin);
+      return;
+    }
+
+  if (++self->frames_since_miss < FRAME_START_DECAY_FRAMES)
+    return;
+
+  self->frames_since_miss = 0;
+  self->frame_start_margin = MAX (self->frame_start_margin
+                                    - FRAME_START_MARGIN_STEP,
+                                  FRAME_START_MARGIN_MIN);
+}
+
+void
+gxr_context_request_frame_reuse (GxrContext *self)
+{
+  self->frame_reuse_requested = TRUE;
+}
+
+gboolean
+gxr_context_is_frame_reused (GxrContext *self)
+{
+  return self->frame_reused;
+}
+
+void
+gxr_context_set_frame_reuse_max_delta (GxrContext *self,
+                                       float       rotation,
+                                       float       translation)
+{
+  self->frame_reuse_max_angle = rotation;
+  self->frame_reuse_max_distance = translation;
+}
+
+/*
+ * The previous projection layer is submitted with the poses it was rendered
+ * with, so the runtime reprojects it to the current head pose. Once the head
+ * moved too far from those poses, reprojection artifacts become visible and
+ * the frame needs to be rendered again.
+ */
+static gboolean
+_can_reuse_frame (GxrContext *self)
+{
+  if (!self->have_rendered_frame || !self->have_valid_pose)
+    return FALSE;
+
+  for (uint32_t i = 0; i < self->view_count; i++)
+    {
+      float angle, distance;
+      _get_pose_delta (&self->projection_views[i].pose, &self->views[i].pose,
+                       &angle, &distance);
+      if (angle > self->frame_reuse_max_angle
+          || distance > self->frame_reuse_max_distance)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+VkExtent2D
+gxr_context_get_render_extent (GxrContext *self, uint32_t view_index)
+{
+  XrViewConfigurationView *view = &self->configuration_views[view_index];
+  VkExtent2D               extent = {
+    .width = MAX (1, (uint32_t) ((float) view->recommendedImageRectWidth
+                                 * self->resolution_scale)),
+    .height = MAX (1, (uint32_t) ((float) view->recommendedImageRectHeight
+                                  * self->resolution_scale)),
+  };
+  return extent;
+}
+
+static void
+_apply_resolution_scale (GxrContext *self)
+{
+  for (uint32_t i = 0; i < self->view_count; i++)
+    {
+      VkExtent2D  extent = gxr_context_get_render_extent (self, i);
+      XrExtent2Di rect_extent = {
+        .width = (int32_t) extent.width,
+        .height = (int32_t) extent.height,
+      };
+      self->projection_views[i].subImage.imageRect.extent = rect_extent;
+      if (self->extensions.depth)
+        self->depth_infos[i].subImage.imageRect.extent = rect_extent;
+    }
+}
+
+void
+gxr_context_set_dynamic_resolution (GxrContext *self,
+                                    gboolean    enabled,
+                                    float       min_scale,
+                                    float       max_scale)
+{
+  self->dynamic_resolution = enabled;
+  self->min_resolution_scale = CLAMP (min_scale, 0.1f, 1.0f);
+  self->max_resolution_scale = CLAMP (max_scale, self->min_resolution_scale,
+                                      1.0f);
+
+  if (enabled)
+    self->resolution_scale = CLAMP (self->resolution_scale,
+                                    self->min_resolution_scale,
+                                    _get_max_resolution_scale (self));
+  else
+    self->resolution_scale = 1.0f;
+}
+
+float
+gxr_context_get_resolution_scale (GxrContext *self)
+{
+  return self->resolution_scale;
+}
+
+/*
+ * GPU time scales with the pixel count, so the square root of the ratio
+ * between target and measured GPU time gives the ideal change of the scale.
+ */
+static void
+_update_resolution_scale (GxrContext *self)
+{
+  const GxrFrameTimestamps *last = gxr_frame_history_get_last (
+    &self->frame_history);
+  /* only adjust once per GPU time sample */
+  if (!last || last->gpu_duration <= 0 || last->predicted_display_period <= 0)
+    return;
+
+  float target = DYNAMIC_RESOLUTION_TARGET
+                 * (float) (last->predicted_display_period / NSEC_PER_USEC);
+  float ideal = self->resolution_scale
+                * sqrtf (target / (float) last->gpu_duration);
+
+  float scale = self->resolution_scale
+                + (ideal - self->resolution_scale)
+                    * DYNAMIC_RESOLUTION_DAMPING;
+  scale = CLAMP (scale, self->min_resolution_scale,
+                 _get_max_resolution_scale (self));
+
+  if (fabsf (scale - self->resolution_scale)
+      < DYNAMIC_RESOLUTION_DEADBAND * self->resolution_scale)
+    return;
+
+  self->resolution_scale = scale;
+}
+
+gboolean
+gxr_context_begin_frame (GxrContext *self)
+{
+  gxr_context_sleep_until_frame_start (self);
+
+  self->frame_timestamps.begin_start = g_get_monotonic_time ();
+
+  if (!_begin_frame (self))
+    {
+      g_printerr ("Could not begin XR frame.\n");
+      return FALSE;
+    }
+
+  /* the app needs to draw newly demoted layers into the projection */
+  gboolean budget_changed = _update_layer_budget (self);
+
+  self->late_latch_pending = FALSE;
+
+  self->frame_reused = self->frame_reuse_requested && !budget_changed
+                       && _can_reuse_frame (self);
+
+  if (!self->frame_reused)
+    {
+      for (uint32_t i = 0; i < self->view_pair_count; i++)
+        {
+          struct GxrSwapchain *swapchains = self->swapchain[i];
+          if (!_acquire_and_wait (self, &swapchains[GxrSwapchainTypeColor]))
+            {
+              g_printerr ("Failed to acquire color image");
+              _abandon_frame (self);
+              return FALSE;
+            }
+
+          if (!_acquire_and_wait (self, &swapchains[GxrSwapchainTypeDepth]))
+            {
+              g_printerr ("Failed to acquire depth image");
+              _abandon_frame (self);
+              return FALSE;
+            }
+        }
+
+      if (self->dynamic_resolution)
+        _update_resolution_scale (self);
+      _apply_resolution_scale (self);
+
+      for (uint32_t i = 0; i < self->view_count; i++)
+        {
+          self->projection_views[i].pose = self->views[i].pose;
+          self->projection_views[i].fov = self->views[i].fov;
+          self->projection_views[i].subImage.imageArrayIndex
+            = i % VIEW_PAIR_SIZE;
+        }
+    }
+
+  /* TODO: update poses, so GxrContext can update them for DeviceManager.
+   * device poses are used for device model rendering, which is not in the
+   * OpenXR spec yet.
+   * Interaction is done using aim and grip pose actions instead.
+   */
+  /* TODO: This can be probably removed */
+  GxrPose poses[GXR_DEVICE_INDEX_MAX];
+  for (int i = 0; i < GXR_DEVICE_INDEX_MAX; i++)
+    {
+      poses[i].is_valid = FALSE;
+    }
+  GxrDeviceManager *dm = gxr_context_get_device_manager (self);
+  gxr_device_manager_update_poses (dm, poses);
+
+  self->frame_timestamps.begin_end = g_get_monotonic_time ();
+
+  return TRUE;
+}
+
+/*
+ * Locates the views again right before the frame is submitted. Must be called
+ * between gxr_context_begin_frame and gxr_context_end_frame. The largest
+ * rotation (degrees) and translation (meters) between the poses from begin
+ * frame and the latched poses are reported, so the application can decide if
+ * it re-renders with them. The submitted poses only change with
+ * gxr_context_apply_late_latch, since the runtime reprojects the image with
+ * the poses it was rendered with.
+ */
+gboolean
+gxr_context_late_latch_views (GxrContext *self,
+                              float      *rotation_delta,
+                              float      *translation_delta)
+{
+  *rotation_delta = 0.0f;
+  *translation_delta = 0.0f;
+  self->late_latch_pending = FALSE;
+
+  /* a reused frame keeps the poses it was rendered with */
+  if (self->frame_reused)
+    return FALSE;
+
+  XrViewState view_state;
+  if (!_locate_views (self, self->latched_views, &view_state))
+    return FALSE;
+
+  if ((view_state.viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) == 0
+      || (view_state.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) == 0)
+    {
+      g_debug ("Late latched views not valid, keeping begin frame poses.");
+      return FALSE;
+    }
+
+  for (uint32_t i = 0; i < self->view_count; i++)
+    {
+      float angle, distance;
+      _get_pose_delta (&self->views[i].pose, &self->latched_views[i].pose,
+                       &angle, &distance);
+      *rotation_delta = fmaxf (*rotation_delta, angle);
+      *translation_delta = fmaxf (*translation_delta, distance);
+    }
+
+  self->late_latch_pending = TRUE;
+  return TRUE;
+}
+
+/*
+ * Submits the views of the last gxr_context_late_latch_views call. The
+ * application has to render the frame with them, gxr_context_get_view
+ * returns the latched views afterwards.
+ */
+gboolean
+gxr_context_apply_late_latch (GxrContext *self)
+{
+  if (!self->late_latch_pending)
+    return FALSE;
+
+  self->late_latch_pending = FALSE;
+
+  for (uint32_t i = 0; i < self->view_count; i++)
+    {
+      self->views[i] = self->latched_views[i];
+      self->projection_views[i].pose = self->views[i].pose;
+      self->projection_views[i].fov = self->views[i].fov;
+    }
+
+  return TRUE;
+}
+
+void
+gxr_context_add_layer (GxrContext *self, GxrLayer *layer)
+{
+  self->layers = g_slist_append (self->layers, layer);
+}
+
+void
+gxr_context_remove_layer (GxrContext *self, GxrLayer *layer)
+{
+  VkRect2D rect;
+  if (gxr_layer_get_atlas_rect (layer, &rect))
+    {
+      gxr_atlas_packer_release (self->layer_atlas, &rect);
+      self->atlas_dirty = TRUE;
+    }
+
+  self->layers = g_slist_remove (self->layers, layer);
+}
+
+uint32_t
+gxr_context_get_max_layer_count (GxrContext *self)
+{
+  return self->max_layer_count;
+}
+
+/*
+ * Sets the size in pixels of the atlas swapchain that demoted layers are
+ * copied into. Layers are packed again with the next gxr_context_begin_frame
+ * and the swapchain is created again once a layer is demoted.
+ */
+void
+gxr_context_set_layer_atlas_extent (GxrContext *self, VkExtent2D extent)
+{
+  gxr_atlas_packer_free (self->layer_atlas);
+  self->layer_atlas = gxr_atlas_packer_new (extent);
+  _clear_layer_atlas (self);
+
+  for (GSList *l = self->layers; l; l = l->next)
+    gxr_layer_set_atlas_rect (GXR_LAYER (l->data), NULL);
+}
+
+VkExtent2D
+gxr_context_get_layer_atlas_extent (GxrContext *self)
+{
+  return gxr_atlas_packer_get_extent (self->layer_atlas);
+}
+
+/*
+ * Places the atlas quad in the play space, from a transformation without
+ * scale. Like a new quad layer, it is 1x1 meters, facing +Z at the origin
+ * until a size and pose are set.
+ */
+void
+gxr_context_set_layer_atlas_pose (GxrContext *self, graphene_matrix_t *pose)
+{
+  graphene_point3d_t    scale;
+  graphene_quaternion_t orientation;
+  graphene_ext_matrix_get_rotation_quaternion (pose, &scale, &orientation);
+
+  graphene_point3d_t position;
+  graphene_ext_matrix_get_translation_point3d (pose, &position);
+
+  float q[4];
+  graphene_ext_quaternion_to_float (&orientation, q);
+
+  self->atlas_layer.pose = (XrPosef){
+    .orientation = {q[0], q[1], q[2], q[3]},
+    .position = {position.x, position.y, position.z},
+  };
+}
+
+/* Size of the atlas quad in meters. */
+void
+gxr_context_set_layer_atlas_size (GxrContext *self, float width, float height)
+{
+  self->atlas_layer.size = (XrExtent2Df){width, height};
+}
+
+static void
+_clear_layer_atlas (GxrContext *self)
+{
+  struct GxrFrameResource *commands = &self->atlas_commands;
+
+  if (self->atlas_command_pool != VK_NULL_HANDLE)
+    {
+      VkDevice device = gulkan_context_get_device_handle (self->gc);
+      if (commands->fence != VK_NULL_HANDLE)
+        {
+          _wait_frame_resource (device, commands);
+          vkDestroyFence (device, commands->fence, NULL);
+        }
+      vkDestroyCommandPool (device, self->atlas_command_pool, NULL);
+    }
+  self->atlas_command_pool = VK_NULL_HANDLE;
+  *commands = (struct GxrFrameResource){0};
+
+  _cleanup_swapchain (self, &self->atlas_swapchain);
+  self->atlas_swapchain = (struct GxrSwapchain){0};
+  self->atlas_has_content = FALSE;
+  self->atlas_dirty = TRUE;
+}
+
+/*
+ * Creates the atlas swapchain in the projection format, and the command
+ * buffer that copies the layers into it.
+ */
+static gboolean
+_create_layer_atlas (GxrContext *self)
+{
+  struct GxrSwapchain *atlas = &self->atlas_swapchain;
+  atlas->array_size = 1;
+  atlas->format = self->swapchain[0][GxrSwapchainTypeColor].format;
+  atlas->extent = gxr_atlas_packer_get_extent (self->layer_atlas);
+
+  XrSwapchainCreateInfo info = {
+    .type = XR_TYPE_SWAPCHAIN_CREATE_INFO,
+    .usageFlags = XR_SWAPCHAIN_USAGE_SAMPLED_BIT
+                  | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT
+                  | XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT,
+    .format = atlas->format,
+    .sampleCount = 1,
+    .width = atlas->extent.width,
+    .height = atlas->extent.height,
+    .faceCount = 1,
+    .arraySize = 1,
+    .mipCount = 1,
+  };
+  XrResult result = xrCreateSwapchain (self->session, &info, &atlas->handle);
+  if (!_check_xr_result (result, "Failed to create layer atlas swapchain!"))
+    {
+      atlas->handle = XR_NULL_HANDLE;
+      return FALSE;
+    }
+
+  if (!_enumerate_swapchain_images (atlas))
+    {
+      _clear_layer_atlas (self);
+      return FALSE;
+    }
+
+  GulkanDevice *gulkan_device = gulkan_context_get_device (self->gc);
+  GulkanQueue  *queue = gulkan_device_get_graphics_queue (gulkan_device);
+  VkDevice      device = gulkan_device_get_handle (gulkan_device);
+
+  VkCommandPoolCreateInfo pool_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+    .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+    .queueFamilyIndex = gulkan_queue_get_family_index (queue),
+  };
+  VkResult res = vkCreateCommandPool (device, &pool_info, NULL,
+                                      &self->atlas_command_pool);
+
+  if (res == VK_SUCCESS)
+    {
+      VkCommandBufferAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = self->atlas_command_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+      };
+      res = vkAllocateCommandBuffers (device, &alloc_info,
+                                      &self->atlas_commands.cmd_buffer);
+    }
+
+  if (res == VK_SUCCESS)
+    {
+      VkFenceCreateInfo fence_info = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+      };
+      res = vkCreateFence (device, &fence_info, NULL,
+                           &self->atlas_commands.fence);
+    }
+
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not create layer atlas commands: %d\n", res);
+      _clear_layer_atlas (self);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+_record_image_barrier (VkCommandBuffer      cmd_buffer,
+                       VkImage              image,
+                       VkImageLayout        old_layout,
+                       VkImageLayout        new_layout,
+                       VkAccessFlags        src_access,
+                       VkAccessFlags        dst_access,
+                       VkPipelineStageFlags src_stage,
+                       VkPipelineStageFlags dst_stage)
+{
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = src_access,
+    .dstAccessMask = dst_access,
+    .oldLayout = old_layout,
+    .newLayout = new_layout,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .levelCount = 1,
+      .layerCount = 1,
+    },
+  };
+  vkCmdPipelineBarrier (cmd_buffer, src_stage, dst_stage, 0, 0, NULL, 0, NULL,
+                        1, &barrier);
+}
+
+/* Blits the first level of the released layer image into its atlas rect. */
+static void
+_record_layer_copy (VkCommandBuffer cmd_buffer,
+                    GxrLayer       *layer,
+                    VkImage         atlas_image,
+                    const VkRect2D *rect)
+{
+  VkImage    image = gxr_layer_get_released_image (layer);
+  VkExtent2D extent = gxr_layer_get_extent (layer);
+
+  /* layer images stay color attachments for the runtime */
+  _record_image_barrier (cmd_buffer, image,
+                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                         VK_ACCESS_TRANSFER_READ_BIT,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  VkImageBlit blit = {
+    .srcSubresource = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .layerCount = 1,
+    },
+    .srcOffsets = {
+      {0, 0, 0},
+      {(int32_t) extent.width, (int32_t) extent.height, 1},
+    },
+    .dstSubresource = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .layerCount = 1,
+    },
+    .dstOffsets = {
+      {rect->offset.x, rect->offset.y, 0},
+      {rect->offset.x + (int32_t) rect->extent.width,
+       rect->offset.y + (int32_t) rect->extent.height, 1},
+    },
+  };
+  vkCmdBlitImage (cmd_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                  atlas_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                  VK_FILTER_NEAREST);
+
+  _record_image_barrier (cmd_buffer, image,
+                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                         VK_ACCESS_TRANSFER_READ_BIT,
+                         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+}
+
+/*
+ * Copies the released image of each demoted layer into its rect of the next
+ * atlas image. Atlas images rotate, so all rects are copied again and the
+ * rest is cleared to transparent.
+ */
+static gboolean
+_draw_layer_atlas (GxrContext *self)
+{
+  if (self->atlas_swapchain.handle == XR_NULL_HANDLE
+      && !_create_layer_atlas (self))
+    return FALSE;
+
+  VkDevice                 device = gulkan_context_get_device_handle (self->gc);
+  struct GxrFrameResource *commands = &self->atlas_commands;
+  struct GxrSwapchain     *atlas = &self->atlas_swapchain;
+
+  /* the command buffer is reused once the last copy completed */
+  _wait_frame_resource (device, commands);
+
+  if (!_acquire_and_wait (self, atlas))
+    return FALSE;
+
+  VkImage         atlas_image = atlas->images[atlas->buffer_index].image;
+  VkCommandBuffer cmd_buffer = commands->cmd_buffer;
+
+  vkResetFences (device, 1, &commands->fence);
+  vkResetCommandBuffer (cmd_buffer, 0);
+
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  vkBeginCommandBuffer (cmd_buffer, &begin_info);
+
+  _record_image_barrier (cmd_buffer, atlas_image, VK_IMAGE_LAYOUT_UNDEFINED,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                         VK_ACCESS_TRANSFER_WRITE_BIT,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  VkClearColorValue       transparent = {.float32 = {0.0f, 0.0f, 0.0f, 0.0f}};
+  VkImageSubresourceRange range = {
+    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+    .levelCount = 1,
+    .layerCount = 1,
+  };
+  vkCmdClearColorImage (cmd_buffer, atlas_image,
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &transparent, 1,
+                        &range);
+  _record_image_barrier (cmd_buffer, atlas_image,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_ACCESS_TRANSFER_WRITE_BIT,
+                         VK_ACCESS_TRANSFER_WRITE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  for (GSList *l = self->layers; l; l = l->next)
+    {
+      GxrLayer *layer = GXR_LAYER (l->data);
+      VkRect2D  rect;
+      if (gxr_layer_is_demoted (layer)
+          && gxr_layer_get_released_image (layer) != VK_NULL_HANDLE
+          && gxr_layer_get_atlas_rect (layer, &rect))
+        _record_layer_copy (cmd_buffer, layer, atlas_image, &rect);
+    }
+
+  _record_image_barrier (cmd_buffer, atlas_image,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                         VK_ACCESS_TRANSFER_WRITE_BIT,
+                         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+  VkResult res = vkEndCommandBuffer (cmd_buffer);
+  if (res == VK_SUCCESS)
+    {
+      GulkanDevice *gulkan_device = gulkan_context_get_device (self->gc);
+      GulkanQueue  *queue = gulkan_device_get_graphics_queue (gulkan_device);
+
+      VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &cmd_buffer,
+      };
+
+      GMutex *mutex = gulkan_queue_get_pool_mutex (queue);
+      g_mutex_lock (mutex);
+      res = vkQueueSubmit (gulkan_queue_get_handle (queue), 1, &submit_info,
+                           commands->fence);
+      g_mutex_unlock (mutex);
+    }
+
+  /* the image is released either way, the runtime expects it back */
+  gboolean released = _release_swapchain (self, atlas);
+
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not submit layer atlas commands: %d\n", res);
+      return FALSE;
+    }
+  commands->pending = TRUE;
+
+  return released;
+}
+
+/*
+ * Copies the demoted layers into the atlas when their rects or content
+ * changed. Returns TRUE if the atlas quad has content to submit.
+ */
+static gboolean
+_update_layer_atlas (GxrContext *self)
+{
+  gboolean has_layers = FALSE;
+  for (GSList *l = self->layers; l; l = l->next)
+    {
+      GxrLayer *layer = GXR_LAYER (l->data);
+      VkRect2D  rect;
+      if (!gxr_layer_is_demoted (layer)
+          || gxr_layer_get_released_image (layer) == VK_NULL_HANDLE
+          || !gxr_layer_get_atlas_rect (layer, &rect))
+        continue;
+
+      has_layers = TRUE;
+      if (gxr_layer_take_updated (layer))
+        self->atlas_dirty = TRUE;
+    }
+
+  if (!has_layers)
+    return FALSE;
+
+  if (self->atlas_dirty || !self->atlas_has_content)
+    {
+      if (!_draw_layer_atlas (self))
+        return FALSE;
+      self->atlas_dirty = FALSE;
+      self->atlas_has_content = TRUE;
+    }
+
+  struct GxrSwapchain *atlas = &self->atlas_swapchain;
+  self->atlas_layer.space = gxr_context_get_tracked_space (self);
+  self->atlas_layer.subImage = (XrSwapchainSubImage){
+    .swapchain = atlas->handle,
+    .imageRect = {
+      .extent = {(int32_t) atlas->extent.width, (int32_t) atlas->extent.height},
+    },
+  };
+
+  return TRUE;
+}
+
+static gint
+_compare_layer_priority (gconstpointer a, gconstpointer b)
+{
+  int32_t priority_a = gxr_layer_get_priority (GXR_LAYER ((gpointer) a));
+  int32_t priority_b = gxr_layer_get_priority (GXR_LAYER ((gpointer) b));
+  return (priority_a < priority_b) - (priority_a > priority_b);
+}
+
+/*
+ * Packs all demoted layers again in priority order, so the atlas does not
+ * stay fragmented. Layers that still do not fit are left out of the atlas.
+ */
+static void
+_repack_layer_atlas (GxrContext *self, GSList *by_priority)
+{
+  gxr_atlas_packer_clear (self->layer_atlas);
+
+  for (GSList *l = by_priority; l; l = l->next)
+    {
+      GxrLayer *layer = GXR_LAYER (l->data);
+      if (!gxr_layer_is_demoted (layer))
+        continue;
+
+      VkRect2D rect;
+      if (gxr_atlas_packer_alloc (self->layer_atlas,
+                                  gxr_layer_get_extent (layer), &rect))
+        gxr_layer_set_atlas_rect (layer, &rect);
+      else
+        gxr_layer_set_atlas_rect (layer, NULL);
+    }
+}
+
+/*
+ * Keeps the visible layers with the highest priority below the runtime
+ * layer limit and demotes the rest, packing them into the layer atlas,
+ * which takes one slot of the limit. Only layers that change their state
+ * are touched, the atlas is only packed again when a new layer does not fit.
+ * Returns TRUE if any layer was promoted or demoted.
+ */
 static gboolean
-_begin_frame (GxrContext *self)
+_update_layer_budget (GxrContext *self)
 {
-  if (!self->session_running)
-    {
-      g_printerr ("Can't begin frame with no session running\n");
-      return FALSE;
-    }
+  /* one layer is taken by the projection */
+  uint32_t budget = self->max_layer_count > 0 ? self->max_layer_count - 1
+                                              : G_MAXUINT32;
 
-  if (self->session_state == XR_SESSION_STATE_EXITING
-      || self->session_state == XR_SESSION_STATE_LOSS_PENDING
-      || self->session_state == XR_SESSION_STATE_STOPPING)
-    return FALSE;
+  uint32_t visible = 0;
+  for (GSList *l = self->layers; l; l = l->next)
+    if (gxr_layer_is_visible (GXR_LAYER (l->data)))
+      visible++;
 
-  XrResult result;
+  /* and one by the atlas quad, once anything is demoted */
+  if (visible > budget && budget > 0)
+    budget--;
 
-  g_mutex_lock (&self->wait_frame_mutex);
-  XrTime predicted_display_time = self->predicted_display_time;
-  g_mutex_unlock (&self->wait_frame_mutex);
+  GSList *by_priority = g_slist_sort (g_slist_copy (self->layers),
+                                      _compare_layer_priority);
 
-  // --- Create projection matrices and view matrices for each eye
-  XrViewLocateInfo viewLocateInfo = {
-    .type = XR_TYPE_VIEW_LOCATE_INFO,
-    .displayTime = predicted_display_time,
-    .space = self->play_space,
-    .viewConfigurationType = self->view_config_type,
-  };
+  gboolean changed = FALSE;
+  gboolean repack = FALSE;
+  uint32_t dedicated = 0;
 
-  XrViewState viewState = {
-    .type = XR_TYPE_VIEW_STATE,
-  };
-  uint32_t viewCountOutput;
-  result = xrLocateViews (self->session, &viewLocateInfo, &viewState,
-                          self->view_count, &viewCountOutput, self->views);
-  if (!_check_xr_result (result, "Could not locate views"))
-    return FALSE;
+  self->layers_demoted = 0;
 
-  // --- Begin frame
-  XrFrameBeginInfo frameBeginInfo = {
-    .type = XR_TYPE_FRAME_BEGIN_INFO,
-  };
+  for (GSList *l = by_priority; l; l = l->next)
+    {
+      GxrLayer *layer = GXR_LAYER (l->data);
+      VkRect2D  rect;
 
-  result = xrBeginFrame (self->session, &frameBeginInfo);
-  if (!_check_xr_result (result, "failed to begin frame!"))
-    return FALSE;
+      gboolean demote = FALSE;
+      if (gxr_layer_is_visible (layer))
+        {
+          if (dedicated < budget)
+            dedicated++;
+          else
+            demote = TRUE;
+        }
 
-  self->have_valid_pose = (viewState.viewStateFlags
-                           & XR_VIEW_STATE_ORIENTATION_VALID_BIT)
-                            != 0
-                          && (viewState.viewStateFlags
-                              & XR_VIEW_STATE_POSITION_VALID_BIT)
-                               != 0;
+      if (!demote)
+        {
+          if (gxr_layer_get_atlas_rect (layer, &rect))
+            {
+              gxr_atlas_packer_release (self->layer_atlas, &rect);
+              gxr_layer_set_atlas_rect (layer, NULL);
+              self->atlas_dirty = TRUE;
+            }
+          changed |= gxr_layer_is_demoted (layer);
+          gxr_layer_set_demoted (layer, FALSE);
+          continue;
+        }
 
-  return TRUE;
-}
+      self->layers_demoted++;
+      if (gxr_layer_is_demoted (layer)
+          && gxr_layer_get_atlas_rect (layer, &rect))
+        continue;
 
-gboolean
-gxr_context_begin_frame (GxrContext *self)
-{
-  if (!_begin_frame (self))
-    {
-      g_printerr ("Could not begin XR frame.\n");
-      return FALSE;
-    }
+      changed |= !gxr_layer_is_demoted (layer);
+      gxr_layer_set_demoted (layer, TRUE);
 
-  for (uint32_t i = 0; i < 2; i++)
-    {
-      self->projection_views[i].pose = self->views[i].pose;
-      self->projection_views[i].fov = self->views[i].fov;
-      self->projection_views[i].subImage.imageArrayIndex = i;
+      if (gxr_atlas_packer_alloc (self->layer_atlas,
+                                  gxr_layer_get_extent (layer), &rect))
+        {
+          gxr_layer_set_atlas_rect (layer, &rect);
+          self->atlas_dirty = TRUE;
+        }
+      else
+        repack = TRUE;
     }
 
-  /* TODO: update poses, so GxrContext can update them for DeviceManager.
-   * device poses are used for device model rendering, which is not in the
-   * OpenXR spec yet.
-   * Interaction is done using aim and grip pose actions instead.
-   */
-  /* TODO: This can be probably removed */
-  GxrPose poses[GXR_DEVICE_INDEX_MAX];
-  for (int i = 0; i < GXR_DEVICE_INDEX_MAX; i++)
+  if (repack)
     {
-      poses[i].is_valid = FALSE;
+      _repack_layer_atlas (self, by_priority);
+      self->atlas_dirty = TRUE;
     }
-  GxrDeviceManager *dm = gxr_context_get_device_manager (self);
-  gxr_device_manager_update_poses (dm, poses);
 
-  return TRUE;
+  g_slist_free (by_priority);
+
+  return changed;
+}
+
+static gint
+_compare_layer_order (gconstpointer a, gconstpointer b)
+{
+  int32_t order_a = gxr_layer_get_order (GXR_LAYER ((gpointer) a));
+  int32_t order_b = gxr_layer_get_order (GXR_LAYER ((gpointer) b));
+  return (order_a > order_b) - (order_a < order_b);
 }
 
 static gboolean
@@ -2124,20 +4626,69 @@ _end_frame (GxrContext *self)
 
   XrResult result;
 
-  const XrCompositionLayerBaseHeader *layers[1];
-  uint32_t                            layer_count = 0;
+  /* stable, so layers with the same order keep their creation order */
+  self->layers = g_slist_sort (self->layers, _compare_layer_order);
+
+  /* copied before the layers are counted, it takes a slot of the limit */
+  gboolean atlas_submitted = self->should_render
+                             && _update_layer_atlas (self);
 
-  g_mutex_lock (&self->wait_frame_mutex);
+  /* the projection and the atlas quad */
+  const XrCompositionLayerBaseHeader **layers
+    = g_malloc (sizeof (XrCompositionLayerBaseHeader *)
+                * (g_slist_length (self->layers) + 2));
+  uint32_t layer_count = 0;
+
+  self->layers_submitted = 0;
+  self->layers_updated = 0;
 
   // if we end up here but shouldn't render, the app probably hasn't rendered
   if (self->should_render)
     {
-      // for submiting projection layers we need a valid pose from xrLocateViews
-      if (self->have_valid_pose)
+      gboolean projection_submitted = FALSE;
+      for (GSList *l = self->layers; l; l = l->next)
         {
-          layers[layer_count++] = (const XrCompositionLayerBaseHeader *) &self
-                                    ->projection_layer;
+          GxrLayer *layer = GXR_LAYER (l->data);
+
+          // for submiting projection layers we need a valid pose from
+          // xrLocateViews
+          if (!projection_submitted && gxr_layer_get_order (layer) >= 0)
+            {
+              if (self->have_valid_pose)
+                layers[layer_count++] = (const XrCompositionLayerBaseHeader *)
+                  &self->projection_layer;
+              projection_submitted = TRUE;
+            }
+
+          if (!gxr_layer_is_submittable (layer))
+            continue;
+
+          /* layers added since the frame began were not budgeted yet */
+          if (self->max_layer_count > 0
+              && layer_count + (projection_submitted ? 0 : 1)
+                     + (atlas_submitted ? 1 : 0)
+                   >= self->max_layer_count)
+            continue;
+
+          /* clean layers show their last released image again */
+          const XrCompositionLayerBaseHeader *header
+            = gxr_layer_get_composition_layer (layer);
+          if (!header)
+            continue;
+
+          layers[layer_count++] = header;
+          self->layers_submitted++;
+          if (gxr_layer_take_updated (layer))
+            self->layers_updated++;
         }
+
+      if (!projection_submitted && self->have_valid_pose)
+        layers[layer_count++] = (const XrCompositionLayerBaseHeader *) &self
+                                  ->projection_layer;
+
+      if (atlas_submitted)
+        layers[layer_count++] = (const XrCompositionLayerBaseHeader *) &self
+                                  ->atlas_layer;
     }
 
   XrFrameEndInfo frame_end_info = {
@@ -2148,27 +4699,78 @@ _end_frame (GxrContext *self)
     .environmentBlendMode = self->blend_mode,
   };
   result = xrEndFrame (self->session, &frame_end_info);
+  g_free (layers);
   if (!_check_xr_result (result, "failed to end frame!"))
     return FALSE;
 
-  g_mutex_unlock (&self->wait_frame_mutex);
-
   return TRUE;
 }
 
-static gboolean
-_release_swapchain (GxrContext *self, struct GxrSwapchain *swapchain)
+static void
+_record_frame (GxrContext *self)
 {
-  (void) self;
-  XrSwapchainImageReleaseInfo swapchainImageReleaseInfo = {
-    .type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO,
-  };
-  XrResult result = xrReleaseSwapchainImage (swapchain->handle,
-                                             &swapchainImageReleaseInfo);
-  if (!_check_xr_result (result, "failed to release swapchain image!"))
-    return FALSE;
+  GxrFrameTimestamps *frame = &self->frame_timestamps;
+  frame->end_end = g_get_monotonic_time ();
+  frame->gpu_duration = self->last_gpu_duration;
+  /* one report is one sample, later frames without a report stay unknown */
+  self->last_gpu_duration = 0;
+  frame->predicted_display_time = self->predicted_display_time;
+  frame->predicted_display_period = self->predicted_display_period;
 
-  return TRUE;
+  uint32_t missed = gxr_frame_history_push (&self->frame_history, frame);
+
+  if (self->frame_start_scheduling)
+    _update_frame_start_margin (self, missed);
+
+  if (missed > 0)
+    {
+      GxrFrameMissedEvent event = {
+        .missed = missed,
+        .total_missed = self->frame_history.missed_frames,
+      };
+      g_debug ("Event: missed %d frames", missed);
+      g_signal_emit (self, context_signals[FRAME_MISSED_EVENT], 0, &event);
+    }
+}
+
+void
+gxr_context_get_frame_stats (GxrContext *self, GxrFrameStats *stats)
+{
+  gxr_frame_history_get_stats (&self->frame_history, stats);
+  stats->layers_submitted = self->layers_submitted;
+  stats->layers_updated = self->layers_updated;
+  stats->layers_demoted = self->layers_demoted;
+  stats->space_cache_hits = self->space_cache.hits;
+  stats->space_cache_misses = self->space_cache.misses;
+}
+
+/*
+ * The runtime releases the next frame at the deadline of the current one,
+ * with just in time scheduling the next frame starts even later.
+ */
+static int64_t
+_get_slack_deadline (GxrContext *self)
+{
+  int64_t period = self->predicted_display_period / NSEC_PER_USEC;
+  int64_t next_deadline = self->frame_deadline + period;
+  int64_t next_start = MAX (self->frame_deadline,
+                            _get_latest_frame_start (self, next_deadline));
+  return next_start - SLACK_MARGIN;
+}
+
+/*
+ * Queues deferrable work that runs after gxr_context_end_frame, but only
+ * while it is expected to finish before the next frame starts. Tasks that
+ * do not fit are carried over to the next frame. The task is run again
+ * while it returns TRUE, so long work can be split into chunks.
+ */
+void
+gxr_context_add_slack_task (GxrContext      *self,
+                            GxrSlackTaskFunc func,
+                            gpointer         data,
+                            GDestroyNotify   destroy)
+{
+  gxr_slack_scheduler_add (self->slack_scheduler, func, data, destroy);
 }
 
 gboolean
@@ -2178,16 +4780,22 @@ gxr_context_end_frame (GxrContext *self,
                        float       min_depth,
                        float       max_depth)
 {
-  if (!_release_swapchain (self, &self->swapchain[GxrSwapchainTypeColor]))
-    {
-      g_printerr ("Could not release xr swapchain\n");
-      return FALSE;
-    }
+  self->frame_timestamps.end_start = g_get_monotonic_time ();
 
-  if (!_release_swapchain (self, &self->swapchain[GxrSwapchainTypeDepth]))
+  for (uint32_t i = 0; i < self->view_pair_count; i++)
     {
-      g_printerr ("Could not release xr swapchain\n");
-      return FALSE;
+      struct GxrSwapchain *swapchains = self->swapchain[i];
+      if (!_release_swapchain (self, &swapchains[GxrSwapchainTypeColor]))
+        {
+          g_printerr ("Could not release xr swapchain\n");
+          return FALSE;
+        }
+
+      if (!_release_swapchain (self, &swapchains[GxrSwapchainTypeDepth]))
+        {
+          g_printerr ("Could not release xr swapchain\n");
+          return FALSE;
+        }
     }
 
   if (self->extensions.depth)
@@ -2206,9 +4814,193 @@ gxr_context_end_frame (GxrContext *self,
       g_printerr ("Could not end xr frame\n");
     }
 
+  if (!self->frame_reused)
+    self->have_rendered_frame = self->should_render && self->have_valid_pose;
+
+  _record_frame (self);
+
+  gxr_slack_scheduler_run (self->slack_scheduler, _get_slack_deadline (self));
+
   return TRUE;
 }
 
+typedef struct
+{
+  GSource source;
+  /* not a ref, the context destroys the source before it goes away */
+  GxrContext    *context;
+  GxrActionSet **action_sets;
+  uint32_t       action_set_count;
+  int64_t        next_event_poll;
+} GxrFrameSource;
+
+static gboolean
+_frame_source_has_frame (GxrContext *self)
+{
+  if (self->pending_frame)
+    return TRUE;
+
+  /* without frame thread, the frame is waited for in dispatch */
+  if (!self->frame_thread)
+    return self->should_submit_frames;
+
+  return g_async_queue_length (self->waited_frames) > 0;
+}
+
+static gboolean
+_frame_source_prepare (GSource *source, gint *timeout)
+{
+  GxrFrameSource *frame_source = (GxrFrameSource *) source;
+  GxrContext     *self = frame_source->context;
+
+  /* xrWaitFrame blocks until the previous frame was begun */
+  if (self->frame_thread && self->should_submit_frames
+      && !self->frame_requested && !self->pending_frame
+      && !self->frame_unbegun)
+    _request_frame (self);
+
+  if (_frame_source_has_frame (self))
+    return TRUE;
+
+  int64_t now = g_source_get_time (source);
+  if (now >= frame_source->next_event_poll)
+    return TRUE;
+
+  *timeout = (gint) ((frame_source->next_event_poll - now + 999) / 1000);
+  return FALSE;
+}
+
+static gboolean
+_frame_source_check (GSource *source)
+{
+  GxrFrameSource *frame_source = (GxrFrameSource *) source;
+
+  return _frame_source_has_frame (frame_source->context)
+         || g_source_get_time (source) >= frame_source->next_event_poll;
+}
+
+/*
+ * Runtime events are handled first, so session state changes are seen before
+ * the frame. Actions are synced after the frame was waited for, so the
+ * callback renders with input sampled as late as possible.
+ */
+static gboolean
+_frame_source_dispatch (GSource *source, GSourceFunc callback, gpointer data)
+{
+  GxrFrameSource *frame_source = (GxrFrameSource *) source;
+  GxrContext     *self = frame_source->context;
+
+  g_source_set_ready_time (source, -1);
+
+  gxr_context_poll_events (self);
+  frame_source->next_event_poll = g_source_get_time (source)
+                                  + FRAME_SOURCE_EVENT_INTERVAL * 1000;
+
+  if (!_frame_source_has_frame (self))
+    return G_SOURCE_CONTINUE;
+
+  if (!gxr_context_wait_frame (self))
+    {
+      if (!self->should_submit_frames)
+        return G_SOURCE_CONTINUE;
+
+      g_printerr ("Failed to wait frame\n");
+      return G_SOURCE_REMOVE;
+    }
+
+  if (frame_source->action_set_count > 0)
+    {
+      gxr_context_sleep_until_frame_start (self);
+      if (!gxr_action_sets_poll (frame_source->action_sets,
+                                 frame_source->action_set_count))
+        g_printerr ("Error polling actions\n");
+    }
+
+  gboolean keep = G_SOURCE_CONTINUE;
+
+  /* the callback may drop the last app ref on the context */
+  g_object_ref (self);
+  if (callback)
+    keep = callback (data);
+
+  /* a frame the callback did not begin is skipped, otherwise the next
+   * xrWaitFrame blocks forever */
+  if (self->frame_unbegun && self->session_running)
+    _skip_frame (self);
+  g_object_unref (self);
+
+  return keep;
+}
+
+static void
+_frame_source_finalize (GSource *source)
+{
+  GxrFrameSource *frame_source = (GxrFrameSource *) source;
+  g_free (frame_source->action_sets);
+}
+
+static GSourceFuncs frame_source_funcs = {
+  .prepare = _frame_source_prepare,
+  .check = _frame_source_check,
+  .dispatch = _frame_source_dispatch,
+  .finalize = _frame_source_finalize,
+};
+
+/* Destroys the frame source, so it never dispatches with a freed context. */
+static void
+_clear_frame_source (GxrContext *self)
+{
+  g_mutex_lock (&self->frame_source_mutex);
+  if (self->frame_source)
+    {
+      g_source_destroy (self->frame_source);
+      g_clear_pointer (&self->frame_source, g_source_unref);
+    }
+  g_mutex_unlock (&self->frame_source_mutex);
+}
+
+/*
+ * Creates a source that dispatches when the next frame was waited for, after
+ * polling runtime events and syncing the given action sets. The callback
+ * should begin and end the frame, a frame it did not begin is skipped.
+ * Between frames, runtime events are still polled at a low rate. Enables pipelined mode, since the frame thread
+ * wakes up the source.
+ * The source does not keep the context alive. Once the context is
+ * finalized, the source is destroyed and never dispatches again.
+ */
+GSource *
+gxr_context_create_frame_source (GxrContext    *self,
+                                 GxrActionSet **action_sets,
+                                 uint32_t       action_set_count)
+{
+  if (self->frame_source && !g_source_is_destroyed (self->frame_source))
+    {
+      g_printerr ("Context already has a frame source.\n");
+      return NULL;
+    }
+  _clear_frame_source (self);
+
+  if (!gxr_context_set_pipelined (self, TRUE))
+    return NULL;
+
+  GSource *source = g_source_new (&frame_source_funcs, sizeof (GxrFrameSource));
+  g_source_set_name (source, "GxrFrameSource");
+
+  GxrFrameSource *frame_source = (GxrFrameSource *) source;
+  frame_source->context = self;
+  frame_source->action_sets = g_new (GxrActionSet *, action_set_count);
+  for (uint32_t i = 0; i < action_set_count; i++)
+    frame_source->action_sets[i] = action_sets[i];
+  frame_source->action_set_count = action_set_count;
+  frame_source->next_event_poll = 0;
+
+  g_mutex_lock (&self->frame_source_mutex);
+  self->frame_source = g_source_ref (source);
+  g_mutex_unlock (&self->frame_source_mutex);
+
+  return source;
+}
+
 void
 gxr_context_request_quit (GxrContext *self)
 {
@@ -2309,36 +5101,51 @@ gxr_context_get_device_manager (GxrContext *self)
 uint32_t
 gxr_context_get_swapchain_length (GxrContext *self)
 {
-  return self->swapchain[GxrSwapchainTypeColor].length;
+  return self->swapchain[0][GxrSwapchainTypeColor].length;
 }
 
 GulkanFrameBuffer *
 gxr_context_get_acquired_framebuffer (GxrContext *self)
 {
-  g_mutex_lock (&self->wait_frame_mutex);
-  GulkanFrameBuffer *fb = GULKAN_FRAME_BUFFER (self->framebuffers
-                                                 [self
-                                                    ->swapchain
-                                                      [GxrSwapchainTypeColor]
-                                                    .buffer_index]);
-  g_mutex_unlock (&self->wait_frame_mutex);
-  return fb;
+  return gxr_context_get_acquired_view_pair_framebuffer (self, 0);
+}
+
+/*
+ * Pair 0 holds the left and right views. In quad view mode pair 1 holds
+ * the left and right foveal insets, rendered with their own render pass.
+ */
+GulkanFrameBuffer *
+gxr_context_get_acquired_view_pair_framebuffer (GxrContext *self,
+                                                uint32_t    pair)
+{
+  g_return_val_if_fail (pair < self->view_pair_count, NULL);
+  uint32_t index = self->swapchain[pair][GxrSwapchainTypeColor].buffer_index;
+  return GULKAN_FRAME_BUFFER (self->framebuffers[pair][index]);
 }
 
 GulkanFrameBuffer *
 gxr_context_get_framebuffer_at (GxrContext *self, uint32_t i)
 {
-  GulkanFrameBuffer *fb = GULKAN_FRAME_BUFFER (self->framebuffers[i]);
+  GulkanFrameBuffer *fb = GULKAN_FRAME_BUFFER (self->framebuffers[0][i]);
   return fb;
 }
 
 uint32_t
 gxr_context_get_buffer_index (GxrContext *self)
 {
-  g_mutex_lock (&self->wait_frame_mutex);
-  uint32_t buffer_index = self->swapchain[GxrSwapchainTypeColor].buffer_index;
-  g_mutex_unlock (&self->wait_frame_mutex);
-  return buffer_index;
+  return self->swapchain[0][GxrSwapchainTypeColor].buffer_index;
+}
+
+uint32_t
+gxr_context_get_view_count (GxrContext *self)
+{
+  return self->view_count;
+}
+
+uint32_t
+gxr_context_get_view_pair_count (GxrContext *self)
+{
+  return self->view_pair_count;
 }
 
 XrSessionState
@@ -2350,10 +5157,7 @@ gxr_context_get_session_state (GxrContext *self)
 XrTime
 gxr_context_get_predicted_display_time (GxrContext *self)
 {
-  g_mutex_lock (&self->wait_frame_mutex);
-  XrTime time = self->predicted_display_time;
-  g_mutex_unlock (&self->wait_frame_mutex);
-  return time;
+  return self->predicted_display_time;
 }
 
 XrInstance
@@ -2374,6 +5178,12 @@ gxr_context_get_tracked_space (GxrContext *self)
   return self->play_space;
 }
 
+XrSpace
+gxr_context_get_view_space (GxrContext *self)
+{
+  return self->view_space;
+}
+
 VkExtent2D
 gxr_context_get_swapchain_extent (GxrContext *self, uint32_t view_index)
 {
@@ -2603,3 +5413,73 @@ gxr_context_is_environment_opaque (GxrContext *self)
 {
   return self->blend_mode == XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
 }
+
+gboolean
+gxr_context_supports_performance_settings (GxrContext *self)
+{
+  return self->extensions.performance_settings;
+}
+
+static XrPerfSettingsLevelEXT
+_perf_level_to_xr (GxrPerfLevel level)
+{
+  switch (level)
+    {
+      case GXR_PERF_LEVEL_POWER_SAVINGS:
+        return XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT;
+      case GXR_PERF_LEVEL_SUSTAINED_LOW:
+        return XR_PERF_SETTINGS_LEVEL_SUSTAINED_LOW_EXT;
+      case GXR_PERF_LEVEL_BOOST:
+        return XR_PERF_SETTINGS_LEVEL_BOOST_EXT;
+      default:
+        return XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT;
+    }
+}
+
+/*
+ * Hints the runtime at the clocks the app needs in a domain. Lower levels
+ * leave thermal headroom for later, BOOST is meant for short bursts.
+ */
+gboolean
+gxr_context_set_performance_level (GxrContext   *self,
+                                   GxrPerfDomain domain,
+                                   GxrPerfLevel  level)
+{
+  if (!self->extensions.performance_settings)
+    return FALSE;
+
+  PFN_xrPerfSettingsSetPerformanceLevelEXT SetPerformanceLevel = NULL;
+  XrResult res = xrGetInstanceProcAddr (self->instance,
+                                        "xrPerfSettingsSetPerformanceLevelEXT",
+                                        (PFN_xrVoidFunction
+                                           *) &SetPerformanceLevel);
+  if (!_check_xr_result (res, "Failed to load "
+                              "xrPerfSettingsSetPerformanceLevelEXT."))
+    return FALSE;
+
+  XrPerfSettingsDomainEXT xr_domain = domain == GXR_PERF_DOMAIN_GPU
+                                        ? XR_PERF_SETTINGS_DOMAIN_GPU_EXT
+                                        : XR_PERF_SETTINGS_DOMAIN_CPU_EXT;
+
+  res = SetPerformanceLevel (self->session, xr_domain,
+                             _perf_level_to_xr (level));
+  return _check_xr_result (res, "Failed to set performance level.");
+}
+
+float
+gxr_context_get_quality_scale (GxrContext *self)
+{
+  return self->quality_scale;
+}
+
+gboolean
+gxr_context_supports_cylinder_layers (GxrContext *self)
+{
+  return self->extensions.cylinder;
+}
+
+gboolean
+gxr_context_supports_equirect_layers (GxrContext *self)
+{
+  return self->extensions.equirect2;
+}
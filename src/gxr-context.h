@@ -18,6 +18,7 @@
 #include <stdint.h>
 
 #include "gxr-device-manager.h"
+#include "gxr-rigid-pose.h"
 
 G_BEGIN_DECLS
 
@@ -39,14 +40,21 @@ struct _GxrContextClass
  * GxrEye:
  * @GXR_EYE_LEFT: Left eye.
  * @GXR_EYE_RIGHT: Right eye.
+ * @GXR_EYE_LEFT_INSET: High resolution inset of the left eye, only with
+ *  quad views.
+ * @GXR_EYE_RIGHT_INSET: High resolution inset of the right eye, only with
+ *  quad views.
  *
- * Type of Gxr viewport.
+ * Type of Gxr viewport. Quad views are used when GXR_VIEW_CONFIG=QUAD is set
+ * and the runtime supports them, see gxr_context_get_view_count.
  *
  **/
 typedef enum
 {
   GXR_EYE_LEFT = 0,
-  GXR_EYE_RIGHT = 1
+  GXR_EYE_RIGHT = 1,
+  GXR_EYE_LEFT_INSET = 2,
+  GXR_EYE_RIGHT_INSET = 3,
 } GxrEye;
 
 /**
@@ -93,6 +101,279 @@ typedef struct
   bool main_session_visible;
 } GxrOverlayEvent;
 
+/**
+ * GxrFramePhase:
+ * @GXR_FRAME_PHASE_WAIT: Time blocked in gxr_context_wait_frame.
+ * @GXR_FRAME_PHASE_BEGIN: Time spent in gxr_context_begin_frame.
+ * @GXR_FRAME_PHASE_RENDER: Time between gxr_context_begin_frame and
+ *  gxr_context_end_frame.
+ * @GXR_FRAME_PHASE_END: Time spent in gxr_context_end_frame.
+ * @GXR_FRAME_PHASE_GPU: GPU time reported with gxr_context_report_gpu_time,
+ *  recorded with the frame that ends after the report. Frames without a
+ *  report are left out of its statistics.
+ * @GXR_FRAME_PHASE_LAST: Number of phases.
+ *
+ * Phases of a frame that are timed by #GxrContext.
+ **/
+typedef enum
+{
+  GXR_FRAME_PHASE_WAIT,
+  GXR_FRAME_PHASE_BEGIN,
+  GXR_FRAME_PHASE_RENDER,
+  GXR_FRAME_PHASE_END,
+  GXR_FRAME_PHASE_GPU,
+  GXR_FRAME_PHASE_LAST,
+} GxrFramePhase;
+
+/**
+ * GxrFramePhaseStats:
+ * @p50: Median duration in microseconds.
+ * @p90: 90th percentile duration in microseconds.
+ * @p99: 99th percentile duration in microseconds.
+ * @max: Maximum duration in microseconds.
+ *
+ * Rolling duration percentiles over the recorded frames.
+ **/
+typedef struct
+{
+  int64_t p50;
+  int64_t p90;
+  int64_t p99;
+  int64_t max;
+} GxrFramePhaseStats;
+
+/**
+ * GxrFrameStats:
+ * @frame_count: Number of recorded frames the statistics are based on.
+ * @predicted_display_period: Last predicted display period in microseconds.
+ * @phases: Statistics for each #GxrFramePhase.
+ * @work: Statistics for the CPU time from the start of
+ *  gxr_context_begin_frame until the end of gxr_context_end_frame.
+ * @remaining_budget: Predicted display period minus the 90th percentile of
+ *  @work in microseconds. Negative when frames are regularly too slow.
+ * @missed_frames: Number of display periods without a submitted frame.
+ * @layers_submitted: Number of #GxrLayer submitted in the last frame.
+ * @layers_updated: Number of submitted #GxrLayer with new content in the
+ *  last frame.
+ * @layers_demoted: Number of #GxrLayer over the runtime layer limit that
+ *  were copied into the layer atlas, which is submitted as one quad, see
+ *  gxr_context_set_layer_atlas_pose().
+ * @space_cache_hits: Number of space locations answered from the per frame
+ *  cache since the context was created.
+ * @space_cache_misses: Number of space locations that needed the runtime
+ *  since the context was created.
+ *
+ * Frame timing statistics of a #GxrContext.
+ **/
+typedef struct
+{
+  uint32_t           frame_count;
+  int64_t            predicted_display_period;
+  GxrFramePhaseStats phases[GXR_FRAME_PHASE_LAST];
+  GxrFramePhaseStats work;
+  int64_t            remaining_budget;
+  uint64_t           missed_frames;
+  uint32_t           layers_submitted;
+  uint32_t           layers_updated;
+  uint32_t           layers_demoted;
+  uint64_t           space_cache_hits;
+  uint64_t           space_cache_misses;
+} GxrFrameStats;
+
+/**
+ * GxrFrameMissedEvent:
+ * @missed: Number of display periods missed since the previous frame.
+ * @total_missed: Number of display periods missed since the context was
+ *  created.
+ *
+ * Event that is emitted when frames were not submitted in time.
+ **/
+typedef struct
+{
+  uint32_t missed;
+  uint64_t total_missed;
+} GxrFrameMissedEvent;
+
+/**
+ * GxrPerfDomain:
+ * @GXR_PERF_DOMAIN_CPU: The CPU of the device.
+ * @GXR_PERF_DOMAIN_GPU: The GPU of the device.
+ * @GXR_PERF_DOMAIN_LAST: Number of domains.
+ *
+ * Processors the performance level can be set for.
+ **/
+typedef enum
+{
+  GXR_PERF_DOMAIN_CPU,
+  GXR_PERF_DOMAIN_GPU,
+  GXR_PERF_DOMAIN_LAST,
+} GxrPerfDomain;
+
+/**
+ * GxrPerfLevel:
+ * @GXR_PERF_LEVEL_POWER_SAVINGS: Lowest clocks, for loading screens or
+ *  idle scenes.
+ * @GXR_PERF_LEVEL_SUSTAINED_LOW: Clocks that can be kept indefinitely at
+ *  low power.
+ * @GXR_PERF_LEVEL_SUSTAINED_HIGH: Clocks that can be kept indefinitely,
+ *  the runtime default.
+ * @GXR_PERF_LEVEL_BOOST: Clocks above the sustained level for short
+ *  bursts of work.
+ *
+ * Performance level requested with gxr_context_set_performance_level.
+ **/
+typedef enum
+{
+  GXR_PERF_LEVEL_POWER_SAVINGS,
+  GXR_PERF_LEVEL_SUSTAINED_LOW,
+  GXR_PERF_LEVEL_SUSTAINED_HIGH,
+  GXR_PERF_LEVEL_BOOST,
+} GxrPerfLevel;
+
+/**
+ * GxrPerfSubDomain:
+ * @GXR_PERF_SUB_DOMAIN_COMPOSITING: The runtime compositor.
+ * @GXR_PERF_SUB_DOMAIN_RENDERING: The rendering of the application.
+ * @GXR_PERF_SUB_DOMAIN_THERMAL: The temperature of the device.
+ * @GXR_PERF_SUB_DOMAIN_LAST: Number of sub domains.
+ *
+ * Part of a #GxrPerfDomain a #GxrPerformanceEvent is about.
+ **/
+typedef enum
+{
+  GXR_PERF_SUB_DOMAIN_COMPOSITING,
+  GXR_PERF_SUB_DOMAIN_RENDERING,
+  GXR_PERF_SUB_DOMAIN_THERMAL,
+  GXR_PERF_SUB_DOMAIN_LAST,
+} GxrPerfSubDomain;
+
+/**
+ * GxrPerfNotificationLevel:
+ * @GXR_PERF_NOTIFICATION_NORMAL: Within the budget.
+ * @GXR_PERF_NOTIFICATION_WARNING: Close to the limit, the runtime may
+ *  throttle soon.
+ * @GXR_PERF_NOTIFICATION_IMPAIRED: Over the limit, frames are dropped or
+ *  the device is throttled.
+ *
+ * Performance state reported by the runtime.
+ **/
+typedef enum
+{
+  GXR_PERF_NOTIFICATION_NORMAL,
+  GXR_PERF_NOTIFICATION_WARNING,
+  GXR_PERF_NOTIFICATION_IMPAIRED,
+} GxrPerfNotificationLevel;
+
+/**
+ * GxrPerformanceEvent:
+ * @domain: The #GxrPerfDomain that changed.
+ * @sub_domain: The #GxrPerfSubDomain that changed.
+ * @from_level: The previous #GxrPerfNotificationLevel.
+ * @to_level: The new #GxrPerfNotificationLevel.
+ * @quality_scale: Recommended scale of the rendering workload between 0
+ *  and 1, based on the worst level over all domains. Dynamic resolution
+ *  does not go above it.
+ *
+ * Event that is emitted when the runtime reports a performance change.
+ **/
+typedef struct
+{
+  GxrPerfDomain            domain;
+  GxrPerfSubDomain         sub_domain;
+  GxrPerfNotificationLevel from_level;
+  GxrPerfNotificationLevel to_level;
+  float                    quality_scale;
+} GxrPerformanceEvent;
+
+/**
+ * GxrPosePrediction:
+ * @pose: The predicted pose in the play space.
+ * @velocity: Linear velocity in meters per second, zero if unknown.
+ * @angular_velocity: Angular velocity in radians per second around the axes
+ *  of the play space, zero if unknown.
+ * @valid: Whether the orientation is tracked.
+ * @position_valid: Whether the position is tracked.
+ * @extrapolated: Whether the pose was extrapolated from the pose and
+ *  velocities at the predicted display time instead of located by the
+ *  runtime.
+ * @error_bound: Estimated upper bound of the position error of an
+ *  extrapolated pose in meters.
+ *
+ * A pose predicted for another time than the predicted display time.
+ **/
+typedef struct
+{
+  GxrRigidPose    pose;
+  graphene_vec3_t velocity;
+  graphene_vec3_t angular_velocity;
+  gboolean        valid;
+  gboolean        position_valid;
+  gboolean        extrapolated;
+  float           error_bound;
+} GxrPosePrediction;
+
+/**
+ * GxrSlackTaskFunc:
+ * @user_data: The data passed to gxr_context_add_slack_task.
+ *
+ * Deferrable work run between frames.
+ *
+ * Returns: %TRUE if the task should run again.
+ **/
+typedef gboolean (*GxrSlackTaskFunc) (gpointer user_data);
+
+/**
+ * GxrThreadRole:
+ * @GXR_THREAD_FRAME: The thread waiting for frames in pipelined mode.
+ * @GXR_THREAD_RENDER: The thread calling gxr_context_set_thread_scheduling,
+ *  usually the one rendering and polling input.
+ * @GXR_THREAD_LAST: Number of roles.
+ *
+ * Threads the scheduling can be configured for.
+ **/
+typedef enum
+{
+  GXR_THREAD_FRAME,
+  GXR_THREAD_RENDER,
+  GXR_THREAD_LAST,
+} GxrThreadRole;
+
+/**
+ * GxrThreadScheduling:
+ * @GXR_THREAD_SCHEDULING_DEFAULT: No elevated scheduling was granted.
+ * @GXR_THREAD_SCHEDULING_REALTIME: SCHED_FIFO or SCHED_RR was granted.
+ * @GXR_THREAD_SCHEDULING_NICE: Realtime scheduling was not granted or
+ *  requested, but the nice level was set.
+ *
+ * Scheduling a thread actually got.
+ **/
+typedef enum
+{
+  GXR_THREAD_SCHEDULING_DEFAULT,
+  GXR_THREAD_SCHEDULING_REALTIME,
+  GXR_THREAD_SCHEDULING_NICE,
+} GxrThreadScheduling;
+
+/**
+ * GxrThreadConfig:
+ * @realtime: Request SCHED_FIFO, or SCHED_RR with @round_robin.
+ * @round_robin: Use SCHED_RR instead of SCHED_FIFO.
+ * @priority: Realtime priority, clamped to the range of the policy.
+ * @nice: Nice level used when realtime scheduling is not granted, 0 keeps
+ *  the current one.
+ * @cpu_mask: Bit mask of the CPUs the thread may run on, 0 for all.
+ *
+ * Scheduling requested for a thread.
+ **/
+typedef struct
+{
+  gboolean realtime;
+  gboolean round_robin;
+  int      priority;
+  int      nice;
+  uint64_t cpu_mask;
+} GxrThreadConfig;
+
 GxrContext *
 gxr_context_new (char *app_name, uint32_t app_version);
 
@@ -105,6 +386,17 @@ gxr_context_new_from_vulkan_extensions (GSList  *instance_ext_list,
 gboolean
 gxr_context_get_head_pose (GxrContext *self, graphene_matrix_t *pose);
 
+gboolean
+gxr_context_predict_head_pose (GxrContext        *self,
+                               float              secs_from_now,
+                               gboolean           extrapolate,
+                               GxrPosePrediction *prediction);
+
+gboolean
+gxr_context_sample_head_pose (GxrContext        *self,
+                              int64_t            time,
+                              GxrPosePrediction *prediction);
+
 void
 gxr_context_get_frustum_angles (GxrContext *self,
                                 GxrEye      eye,
@@ -119,6 +411,16 @@ gxr_context_init_framebuffers (GxrContext           *self,
                                VkSampleCountFlagBits sample_count,
                                GulkanRenderPass    **render_pass);
 
+gboolean
+gxr_context_init_frame_resources (GxrContext *self,
+                                  uint32_t    max_frames_in_flight);
+
+VkCommandBuffer
+gxr_context_begin_frame_commands (GxrContext *self);
+
+gboolean
+gxr_context_submit_frame_commands (GxrContext *self);
+
 void
 gxr_context_poll_events (GxrContext *self);
 
@@ -148,6 +450,62 @@ gxr_context_end_frame (GxrContext *self,
                        float       min_depth,
                        float       max_depth);
 
+void
+gxr_context_request_frame_reuse (GxrContext *self);
+
+gboolean
+gxr_context_is_frame_reused (GxrContext *self);
+
+void
+gxr_context_set_frame_reuse_max_delta (GxrContext *self,
+                                       float       rotation,
+                                       float       translation);
+
+gboolean
+gxr_context_late_latch_views (GxrContext *self,
+                              float      *rotation_delta,
+                              float      *translation_delta);
+
+gboolean
+gxr_context_apply_late_latch (GxrContext *self);
+
+void
+gxr_context_get_frame_stats (GxrContext *self, GxrFrameStats *stats);
+
+void
+gxr_context_report_gpu_time (GxrContext *self, int64_t gpu_time);
+
+void
+gxr_context_set_frame_start_scheduling (GxrContext *self, gboolean enabled);
+
+void
+gxr_context_sleep_until_frame_start (GxrContext *self);
+
+void
+gxr_context_add_slack_task (GxrContext      *self,
+                            GxrSlackTaskFunc func,
+                            gpointer         data,
+                            GDestroyNotify   destroy);
+
+gboolean
+gxr_context_set_pipelined (GxrContext *self, gboolean pipelined);
+
+gboolean
+gxr_context_is_pipelined (GxrContext *self);
+
+void
+gxr_context_set_thread_scheduling (GxrContext            *self,
+                                   GxrThreadRole          role,
+                                   const GxrThreadConfig *config);
+
+GxrThreadScheduling
+gxr_context_get_thread_scheduling (GxrContext *self, GxrThreadRole role);
+
+GSource *
+gxr_context_create_frame_source (GxrContext    *self,
+                                 GxrActionSet **action_sets,
+                                 uint32_t       action_set_count);
+
 void
 gxr_context_request_quit (GxrContext *self);
 
@@ -170,15 +528,52 @@ gxr_context_get_swapchain_length (GxrContext *self);
 GulkanFrameBuffer *
 gxr_context_get_acquired_framebuffer (GxrContext *self);
 
+GulkanFrameBuffer *
+gxr_context_get_acquired_view_pair_framebuffer (GxrContext *self,
+                                                uint32_t    pair);
+
 GulkanFrameBuffer *
 gxr_context_get_framebuffer_at (GxrContext *self, uint32_t i);
 
+uint32_t
+gxr_context_get_view_count (GxrContext *self);
+
+uint32_t
+gxr_context_get_view_pair_count (GxrContext *self);
+
 VkExtent2D
 gxr_context_get_swapchain_extent (GxrContext *self, uint32_t view_index);
 
+VkExtent2D
+gxr_context_get_render_extent (GxrContext *self, uint32_t view_index);
+
+void
+gxr_context_set_dynamic_resolution (GxrContext *self,
+                                    gboolean    enabled,
+                                    float       min_scale,
+                                    float       max_scale);
+
+float
+gxr_context_get_resolution_scale (GxrContext *self);
+
 uint32_t
 gxr_context_get_buffer_index (GxrContext *self);
 
+uint32_t
+gxr_context_get_max_layer_count (GxrContext *self);
+
+void
+gxr_context_set_layer_atlas_extent (GxrContext *self, VkExtent2D extent);
+
+VkExtent2D
+gxr_context_get_layer_atlas_extent (GxrContext *self);
+
+void
+gxr_context_set_layer_atlas_pose (GxrContext *self, graphene_matrix_t *pose);
+
+void
+gxr_context_set_layer_atlas_size (GxrContext *self, float width, float height);
+
 gboolean
 gxr_context_attach_action_sets (GxrContext    *self,
                                 GxrActionSet **sets,
@@ -187,6 +582,31 @@ gxr_context_attach_action_sets (GxrContext    *self,
 gboolean
 gxr_context_is_environment_opaque (GxrContext *self);
 
+gboolean
+gxr_context_supports_cylinder_layers (GxrContext *self);
+
+gboolean
+gxr_context_supports_equirect_layers (GxrContext *self);
+
+gboolean
+gxr_context_supports_performance_settings (GxrContext *self);
+
+gboolean
+gxr_context_set_performance_level (GxrContext   *self,
+                                   GxrPerfDomain domain,
+                                   GxrPerfLevel  level);
+
+float
+gxr_context_get_quality_scale (GxrContext *self);
+
+GulkanVertexBuffer *
+gxr_context_get_visibility_mask_mesh (GxrContext *self);
+
+gboolean
+gxr_context_record_visibility_mask (GxrContext     *self,
+                                    VkCommandBuffer cmd_buffer,
+                                    uint32_t        pair);
+
 G_END_DECLS
 
 #endif /* GXR_CONTEXT_H_ */
@@ -11,11 +11,11 @@ struct _GxrController
 {
   GxrDevice parent;
 
-  graphene_matrix_t pointer_pose;
-  gboolean          pointer_pose_valid;
+  GxrRigidPose pointer_pose;
+  gboolean     pointer_pose_valid;
 
-  graphene_matrix_t hand_grip_pose;
-  gboolean          hand_grip_pose_valid;
+  GxrRigidPose hand_grip_pose;
+  gboolean     hand_grip_pose_valid;
 };
 
 G_DEFINE_TYPE (GxrController, gxr_controller, GXR_TYPE_DEVICE)
@@ -47,8 +47,8 @@ gxr_controller_class_init (GxrControllerClass *klass)
 static void
 gxr_controller_init (GxrController *self)
 {
-  graphene_matrix_init_identity (&self->pointer_pose);
-  graphene_matrix_init_identity (&self->hand_grip_pose);
+  gxr_rigid_pose_init_identity (&self->pointer_pose);
+  gxr_rigid_pose_init_identity (&self->hand_grip_pose);
 
   self->pointer_pose_valid = FALSE;
   self->hand_grip_pose_valid = FALSE;
@@ -75,13 +75,20 @@ gxr_controller_finalize (GObject *gobject)
 void
 gxr_controller_get_hand_grip_pose (GxrController *self, graphene_matrix_t *pose)
 {
-  graphene_matrix_init_from_matrix (pose, &self->hand_grip_pose);
+  gxr_rigid_pose_to_matrix (&self->hand_grip_pose, pose);
+}
+
+void
+gxr_controller_get_hand_grip_rigid_pose (GxrController *self,
+                                         GxrRigidPose  *pose)
+{
+  *pose = self->hand_grip_pose;
 }
 
 void
 gxr_controller_update_pointer_pose (GxrController *self, GxrPoseEvent *event)
 {
-  graphene_matrix_init_from_matrix (&self->pointer_pose, &event->pose);
+  self->pointer_pose = event->pose;
   gboolean valid = event->device_connected && event->active && event->valid;
   self->pointer_pose_valid = valid;
   g_signal_emit (self, signals[MOVE], 0, event);
@@ -90,7 +97,7 @@ gxr_controller_update_pointer_pose (GxrController *self, GxrPoseEvent *event)
 void
 gxr_controller_update_hand_grip_pose (GxrController *self, GxrPoseEvent *event)
 {
-  graphene_matrix_init_from_matrix (&self->hand_grip_pose, &event->pose);
+  self->hand_grip_pose = event->pose;
   gboolean valid = event->device_connected && event->active && event->valid;
   self->hand_grip_pose_valid = valid;
 }
@@ -104,6 +111,13 @@ gxr_controller_is_pointer_pose_valid (GxrController *self)
 gboolean
 gxr_controller_get_pointer_pose (GxrController *self, graphene_matrix_t *pose)
 {
-  graphene_matrix_init_from_matrix (pose, &self->pointer_pose);
+  gxr_rigid_pose_to_matrix (&self->pointer_pose, pose);
+  return self->pointer_pose_valid;
+}
+
+gboolean
+gxr_controller_get_pointer_rigid_pose (GxrController *self, GxrRigidPose *pose)
+{
+  *pose = self->pointer_pose;
   return self->pointer_pose_valid;
 }
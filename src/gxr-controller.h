@@ -12,6 +12,7 @@
 #include <graphene.h>
 
 #include "gxr-device.h"
+#include "gxr-rigid-pose.h"
 
 G_BEGIN_DECLS
 
@@ -66,7 +67,7 @@ typedef struct {
  * GxrPoseEvent:
  * @active: Whether or not this action is currently available to be bound in the
  *active action set.
- * @pose: The #graphene_matrix_t pose.
+ * @pose: The #GxrRigidPose pose.
  * @velocity: Velocity
  * @angular_velocity: Angular velocity.
  * @valid: Whether the pose is valid.
@@ -79,7 +80,7 @@ typedef struct {
 // https://gitlab.gnome.org/GNOME/gtk-doc/-/issues/91
 typedef struct {
   gboolean          active;
-  graphene_matrix_t pose;
+  GxrRigidPose      pose;
   graphene_vec3_t   velocity;
   graphene_vec3_t   angular_velocity;
   gboolean          valid;
@@ -95,6 +96,10 @@ void
 gxr_controller_get_hand_grip_pose (GxrController     *self,
                                    graphene_matrix_t *pose);
 
+void
+gxr_controller_get_hand_grip_rigid_pose (GxrController *self,
+                                         GxrRigidPose  *pose);
+
 void
 gxr_controller_update_pointer_pose (GxrController *self, GxrPoseEvent *event);
 
@@ -107,6 +112,9 @@ gxr_controller_is_pointer_pose_valid (GxrController *self);
 gboolean
 gxr_controller_get_pointer_pose (GxrController *self, graphene_matrix_t *pose);
 
+gboolean
+gxr_controller_get_pointer_rigid_pose (GxrController *self, GxrRigidPose *pose);
+
 G_END_DECLS
 
 #endif /* GXR_CONTROLLER_H_ */
@@ -0,0 +1,123 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-cylinder-layer.h"
+
+#include "gxr-layer-private.h"
+
+struct _GxrCylinderLayer
+{
+  GxrLayer parent;
+
+  XrCompositionLayerCylinderKHR layer;
+};
+
+G_DEFINE_TYPE (GxrCylinderLayer, gxr_cylinder_layer, GXR_TYPE_LAYER)
+
+static const void *
+_get_composition_layer (GxrLayer *layer)
+{
+  GxrCylinderLayer *self = GXR_CYLINDER_LAYER (layer);
+
+  self->layer.space = gxr_layer_get_xr_space (layer);
+  self->layer.pose = gxr_layer_get_xr_pose (layer);
+  self->layer.subImage = gxr_layer_get_sub_image (layer);
+
+  return &self->layer;
+}
+
+static void
+gxr_cylinder_layer_class_init (GxrCylinderLayerClass *klass)
+{
+  GxrLayerClass *layer_class = GXR_LAYER_CLASS (klass);
+  layer_class->get_composition_layer = _get_composition_layer;
+}
+
+static void
+gxr_cylinder_layer_init (GxrCylinderLayer *self)
+{
+  self->layer = (XrCompositionLayerCylinderKHR){
+    .type = XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR,
+    .layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
+    .eyeVisibility = XR_EYE_VISIBILITY_BOTH,
+    .radius = 1.0f,
+    .centralAngle = 1.0f,
+    .aspectRatio = 1.0f,
+  };
+}
+
+/*
+ * Creates a cylinder layer with its own swapchain of the given extent and
+ * format. The cylinder has a radius of 1 meter around the origin of the play
+ * space, covering 1 radian and keeping the aspect ratio of extent until
+ * its shape and pose are set.
+ * Returns NULL if the runtime does not support cylinder layers.
+ */
+GxrCylinderLayer *
+gxr_cylinder_layer_new (GxrContext *context,
+                        VkExtent2D  extent,
+                        VkFormat    format)
+{
+  if (!gxr_context_supports_cylinder_layers (context))
+    {
+      g_debug ("Runtime does not support cylinder layers.");
+      return NULL;
+    }
+
+  GxrCylinderLayer *self = (GxrCylinderLayer *)
+    g_object_new (GXR_TYPE_CYLINDER_LAYER, 0);
+
+  if (!gxr_layer_initialize (GXR_LAYER (self), context, extent, format,
+                             FALSE, 1))
+    {
+      g_object_unref (self);
+      return NULL;
+    }
+
+  self->layer.aspectRatio = (float) extent.width / (float) extent.height;
+
+  return self;
+}
+
+/* Radius of the cylinder in meters. */
+void
+gxr_cylinder_layer_set_radius (GxrCylinderLayer *self, float radius)
+{
+  self->layer.radius = radius;
+}
+
+float
+gxr_cylinder_layer_get_radius (GxrCylinderLayer *self)
+{
+  return self->layer.radius;
+}
+
+/* Angle of the visible section of the cylinder in radians. */
+void
+gxr_cylinder_layer_set_central_angle (GxrCylinderLayer *self, float angle)
+{
+  self->layer.centralAngle = angle;
+}
+
+float
+gxr_cylinder_layer_get_central_angle (GxrCylinderLayer *self)
+{
+  return self->layer.centralAngle;
+}
+
+/* Ratio of the arc length to the height of the visible section. */
+void
+gxr_cylinder_layer_set_aspect_ratio (GxrCylinderLayer *self,
+                                     float             aspect_ratio)
+{
+  self->layer.aspectRatio = aspect_ratio;
+}
+
+float
+gxr_cylinder_layer_get_aspect_ratio (GxrCylinderLayer *self)
+{
+  return self->layer.aspectRatio;
+}
@@ -0,0 +1,54 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_CYLINDER_LAYER_H_
+#define GXR_CYLINDER_LAYER_H_
+
+#if !defined(GXR_INSIDE) && !defined(GXR_COMPILATION)
+#error "Only <gxr.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+
+#include "gxr-context.h"
+#include "gxr-layer.h"
+
+G_BEGIN_DECLS
+
+#define GXR_TYPE_CYLINDER_LAYER gxr_cylinder_layer_get_type ()
+G_DECLARE_FINAL_TYPE (GxrCylinderLayer,
+                      gxr_cylinder_layer,
+                      GXR,
+                      CYLINDER_LAYER,
+                      GxrLayer)
+
+GxrCylinderLayer *
+gxr_cylinder_layer_new (GxrContext *context,
+                        VkExtent2D  extent,
+                        VkFormat    format);
+
+void
+gxr_cylinder_layer_set_radius (GxrCylinderLayer *self, float radius);
+
+float
+gxr_cylinder_layer_get_radius (GxrCylinderLayer *self);
+
+void
+gxr_cylinder_layer_set_central_angle (GxrCylinderLayer *self, float angle);
+
+float
+gxr_cylinder_layer_get_central_angle (GxrCylinderLayer *self);
+
+void
+gxr_cylinder_layer_set_aspect_ratio (GxrCylinderLayer *self,
+                                     float             aspect_ratio);
+
+float
+gxr_cylinder_layer_get_aspect_ratio (GxrCylinderLayer *self);
+
+G_END_DECLS
+
+#endif /* GXR_CYLINDER_LAYER_H_ */
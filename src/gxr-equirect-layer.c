@@ -0,0 +1,124 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-equirect-layer.h"
+
+#include <math.h>
+
+#include "gxr-layer-private.h"
+
+struct _GxrEquirectLayer
+{
+  GxrLayer parent;
+
+  XrCompositionLayerEquirect2KHR layer;
+};
+
+G_DEFINE_TYPE (GxrEquirectLayer, gxr_equirect_layer, GXR_TYPE_LAYER)
+
+static const void *
+_get_composition_layer (GxrLayer *layer)
+{
+  GxrEquirectLayer *self = GXR_EQUIRECT_LAYER (layer);
+
+  self->layer.space = gxr_layer_get_xr_space (layer);
+  self->layer.pose = gxr_layer_get_xr_pose (layer);
+  self->layer.subImage = gxr_layer_get_sub_image (layer);
+
+  return &self->layer;
+}
+
+static void
+gxr_equirect_layer_class_init (GxrEquirectLayerClass *klass)
+{
+  GxrLayerClass *layer_class = GXR_LAYER_CLASS (klass);
+  layer_class->get_composition_layer = _get_composition_layer;
+}
+
+static void
+gxr_equirect_layer_init (GxrEquirectLayer *self)
+{
+  /* a radius of 0 places the sphere at infinity */
+  self->layer = (XrCompositionLayerEquirect2KHR){
+    .type = XR_TYPE_COMPOSITION_LAYER_EQUIRECT2_KHR,
+    .layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
+    .eyeVisibility = XR_EYE_VISIBILITY_BOTH,
+    .radius = 0.0f,
+    .centralHorizontalAngle = 2.0f * (float) G_PI,
+    .upperVerticalAngle = (float) G_PI_2,
+    .lowerVerticalAngle = -(float) G_PI_2,
+  };
+}
+
+/*
+ * Creates an equirect layer with its own swapchain of the given extent and
+ * format. It maps the whole image to a sphere at infinity around the origin
+ * of the play space until its shape and pose are set.
+ * Returns NULL if the runtime does not support equirect layers.
+ */
+GxrEquirectLayer *
+gxr_equirect_layer_new (GxrContext *context,
+                        VkExtent2D  extent,
+                        VkFormat    format)
+{
+  if (!gxr_context_supports_equirect_layers (context))
+    {
+      g_debug ("Runtime does not support equirect layers.");
+      return NULL;
+    }
+
+  GxrEquirectLayer *self = (GxrEquirectLayer *)
+    g_object_new (GXR_TYPE_EQUIRECT_LAYER, 0);
+
+  if (!gxr_layer_initialize (GXR_LAYER (self), context, extent, format,
+                             FALSE, 1))
+    {
+      g_object_unref (self);
+      return NULL;
+    }
+
+  return self;
+}
+
+/* Radius of the sphere in meters, 0 for a sphere at infinity. */
+void
+gxr_equirect_layer_set_radius (GxrEquirectLayer *self, float radius)
+{
+  self->layer.radius = radius;
+}
+
+float
+gxr_equirect_layer_get_radius (GxrEquirectLayer *self)
+{
+  return self->layer.radius;
+}
+
+/*
+ * Section of the sphere the image is mapped to in radians: the horizontal
+ * angle centered on -Z, and the vertical angles above and below the
+ * horizon, lower being negative below it.
+ */
+void
+gxr_equirect_layer_set_angles (GxrEquirectLayer *self,
+                               float             horizontal,
+                               float             upper,
+                               float             lower)
+{
+  self->layer.centralHorizontalAngle = horizontal;
+  self->layer.upperVerticalAngle = upper;
+  self->layer.lowerVerticalAngle = lower;
+}
+
+void
+gxr_equirect_layer_get_angles (GxrEquirectLayer *self,
+                               float            *horizontal,
+                               float            *upper,
+                               float            *lower)
+{
+  *horizontal = self->layer.centralHorizontalAngle;
+  *upper = self->layer.upperVerticalAngle;
+  *lower = self->layer.lowerVerticalAngle;
+}
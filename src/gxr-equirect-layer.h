@@ -0,0 +1,53 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_EQUIRECT_LAYER_H_
+#define GXR_EQUIRECT_LAYER_H_
+
+#if !defined(GXR_INSIDE) && !defined(GXR_COMPILATION)
+#error "Only <gxr.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+
+#include "gxr-context.h"
+#include "gxr-layer.h"
+
+G_BEGIN_DECLS
+
+#define GXR_TYPE_EQUIRECT_LAYER gxr_equirect_layer_get_type ()
+G_DECLARE_FINAL_TYPE (GxrEquirectLayer,
+                      gxr_equirect_layer,
+                      GXR,
+                      EQUIRECT_LAYER,
+                      GxrLayer)
+
+GxrEquirectLayer *
+gxr_equirect_layer_new (GxrContext *context,
+                        VkExtent2D  extent,
+                        VkFormat    format);
+
+void
+gxr_equirect_layer_set_radius (GxrEquirectLayer *self, float radius);
+
+float
+gxr_equirect_layer_get_radius (GxrEquirectLayer *self);
+
+void
+gxr_equirect_layer_set_angles (GxrEquirectLayer *self,
+                               float             horizontal,
+                               float             upper,
+                               float             lower);
+
+void
+gxr_equirect_layer_get_angles (GxrEquirectLayer *self,
+                               float            *horizontal,
+                               float            *upper,
+                               float            *lower);
+
+G_END_DECLS
+
+#endif /* GXR_EQUIRECT_LAYER_H_ */
@@ -0,0 +1,463 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-external-image.h"
+
+#include <unistd.h>
+
+#include "gxr-layer-private.h"
+
+struct _GxrExternalImage
+{
+  GObject parent;
+
+  GulkanContext *context;
+  VkDevice       device;
+  uint32_t       graphics_family;
+
+  VkImage        image;
+  VkDeviceMemory memory;
+  VkImageView    image_view;
+  VkExtent2D     extent;
+  VkFormat       format;
+  /* layout the image was acquired in */
+  VkImageLayout layout;
+};
+
+G_DEFINE_TYPE (GxrExternalImage, gxr_external_image, G_TYPE_OBJECT)
+
+static void
+gxr_external_image_finalize (GObject *gobject);
+
+static void
+gxr_external_image_class_init (GxrExternalImageClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  object_class->finalize = gxr_external_image_finalize;
+}
+
+static void
+gxr_external_image_init (GxrExternalImage *self)
+{
+  self->context = NULL;
+  self->device = VK_NULL_HANDLE;
+  self->image = VK_NULL_HANDLE;
+  self->memory = VK_NULL_HANDLE;
+  self->image_view = VK_NULL_HANDLE;
+  self->layout = VK_IMAGE_LAYOUT_UNDEFINED;
+}
+
+static VkExternalMemoryHandleTypeFlagBits
+_get_vk_handle_type (GxrExternalHandleType type)
+{
+  if (type == GXR_EXTERNAL_HANDLE_DMA_BUF)
+    return VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+  return VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+}
+
+static gboolean
+_create_image (GxrExternalImage *self, const GxrExternalImageInfo *info)
+{
+  gboolean dma_buf = info->handle_type == GXR_EXTERNAL_HANDLE_DMA_BUF;
+
+  /* only present when VK_EXT_image_drm_format_modifier is enabled */
+  if (dma_buf
+      && !vkGetDeviceProcAddr (self->device,
+                               "vkGetImageDrmFormatModifierPropertiesEXT"))
+    {
+      g_printerr ("Importing dma-buf requires %s.\n",
+                  VK_EXT_IMAGE_DRM_FORMAT_MODIFIER_EXTENSION_NAME);
+      return FALSE;
+    }
+
+  VkSubresourceLayout plane_layout = {
+    .offset = info->offset,
+    .rowPitch = info->row_pitch,
+  };
+  VkImageDrmFormatModifierExplicitCreateInfoEXT modifier_info = {
+    .sType
+    = VK_STRUCTURE_TYPE_IMAGE_DRM_FORMAT_MODIFIER_EXPLICIT_CREATE_INFO_EXT,
+    .drmFormatModifier = info->drm_format_modifier,
+    .drmFormatModifierPlaneCount = 1,
+    .pPlaneLayouts = &plane_layout,
+  };
+  VkExternalMemoryImageCreateInfo external_info = {
+    .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+    .pNext = dma_buf ? &modifier_info : NULL,
+    .handleTypes = _get_vk_handle_type (info->handle_type),
+  };
+  VkImageCreateInfo image_info = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+    .pNext = &external_info,
+    .imageType = VK_IMAGE_TYPE_2D,
+    .format = info->format,
+    .extent = {info->extent.width, info->extent.height, 1},
+    .mipLevels = 1,
+    .arrayLayers = 1,
+    .samples = VK_SAMPLE_COUNT_1_BIT,
+    .tiling = dma_buf ? VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT
+                      : VK_IMAGE_TILING_OPTIMAL,
+    .usage = info->usage,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+
+  VkResult res = vkCreateImage (self->device, &image_info, NULL, &self->image);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not create external image: %d\n", res);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+_find_memory_type (GxrExternalImage           *self,
+                   const GxrExternalImageInfo *info,
+                   uint32_t                    type_bits,
+                   uint32_t                   *index)
+{
+  /* the fd tells which memory types it can be imported as */
+  if (info->handle_type == GXR_EXTERNAL_HANDLE_DMA_BUF)
+    {
+      PFN_vkGetMemoryFdPropertiesKHR GetMemoryFdPropertiesKHR
+        = (PFN_vkGetMemoryFdPropertiesKHR)
+          vkGetDeviceProcAddr (self->device, "vkGetMemoryFdPropertiesKHR");
+      if (!GetMemoryFdPropertiesKHR)
+        {
+          g_printerr ("Could not load vkGetMemoryFdPropertiesKHR.\n");
+          return FALSE;
+        }
+
+      VkMemoryFdPropertiesKHR fd_properties = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_FD_PROPERTIES_KHR,
+      };
+      VkResult res = GetMemoryFdPropertiesKHR (
+        self->device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT, info->fd,
+        &fd_properties);
+      if (res != VK_SUCCESS)
+        {
+          g_printerr ("Could not get dma-buf memory properties: %d\n", res);
+          return FALSE;
+        }
+      type_bits &= fd_properties.memoryTypeBits;
+    }
+
+  GulkanDevice    *gulkan_device = gulkan_context_get_device (self->context);
+  VkPhysicalDevice physical_device
+    = gulkan_device_get_physical_handle (gulkan_device);
+
+  VkPhysicalDeviceMemoryProperties properties;
+  vkGetPhysicalDeviceMemoryProperties (physical_device, &properties);
+
+  /* prefer device local memory, as exporters usually allocate it */
+  for (uint32_t i = 0; i < properties.memoryTypeCount; i++)
+    if ((type_bits & (1u << i))
+        && (properties.memoryTypes[i].propertyFlags
+            & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+      {
+        *index = i;
+        return TRUE;
+      }
+
+  for (uint32_t i = 0; i < properties.memoryTypeCount; i++)
+    if (type_bits & (1u << i))
+      {
+        *index = i;
+        return TRUE;
+      }
+
+  g_printerr ("No memory type to import the external image.\n");
+  return FALSE;
+}
+
+static gboolean
+_import_memory (GxrExternalImage *self, const GxrExternalImageInfo *info)
+{
+  VkMemoryRequirements requirements;
+  vkGetImageMemoryRequirements (self->device, self->image, &requirements);
+
+  VkMemoryDedicatedAllocateInfo dedicated_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+    .image = self->image,
+  };
+  VkImportMemoryFdInfoKHR import_info = {
+    .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+    .pNext = &dedicated_info,
+    .handleType = _get_vk_handle_type (info->handle_type),
+    .fd = info->fd,
+  };
+  VkMemoryAllocateInfo alloc_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+    .pNext = &import_info,
+    .allocationSize = MAX (info->allocation_size, requirements.size),
+  };
+
+  if (!_find_memory_type (self, info, requirements.memoryTypeBits,
+                          &alloc_info.memoryTypeIndex))
+    return FALSE;
+
+  /* the fd is owned by the memory from here on */
+  VkResult res = vkAllocateMemory (self->device, &alloc_info, NULL,
+                                   &self->memory);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not import external memory: %d\n", res);
+      return FALSE;
+    }
+
+  res = vkBindImageMemory (self->device, self->image, self->memory, 0);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not bind external memory: %d\n", res);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+_create_image_view (GxrExternalImage *self)
+{
+  VkImageViewCreateInfo view_info = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+    .image = self->image,
+    .viewType = VK_IMAGE_VIEW_TYPE_2D,
+    .format = self->format,
+    .subresourceRange = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .levelCount = 1,
+      .layerCount = 1,
+    },
+  };
+  VkResult res = vkCreateImageView (self->device, &view_info, NULL,
+                                    &self->image_view);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not create external image view: %d\n", res);
+      return FALSE;
+    }
+  return TRUE;
+}
+
+/*
+ * Imports an image another process or API exported as fd, without copying
+ * its content. The image takes ownership of the fd, it is also closed when
+ * NULL is returned.
+ * The image can be sampled in a projection render through its image view,
+ * or blitted into a layer, after it was acquired from the external queue
+ * family with gxr_external_image_record_acquire.
+ */
+GxrExternalImage *
+gxr_external_image_new_from_fd (GulkanContext              *context,
+                                const GxrExternalImageInfo *info)
+{
+  GxrExternalImage *self = (GxrExternalImage *)
+    g_object_new (GXR_TYPE_EXTERNAL_IMAGE, 0);
+
+  GulkanDevice *gulkan_device = gulkan_context_get_device (context);
+
+  self->context = g_object_ref (context);
+  self->device = gulkan_device_get_handle (gulkan_device);
+  self->graphics_family = gulkan_queue_get_family_index (
+    gulkan_device_get_graphics_queue (gulkan_device));
+  self->extent = info->extent;
+  self->format = info->format;
+
+  if (!_create_image (self, info) || !_import_memory (self, info)
+      || !_create_image_view (self))
+    {
+      /* imported memory closes the fd when it is freed */
+      if (self->memory == VK_NULL_HANDLE)
+        close (info->fd);
+      g_object_unref (self);
+      return NULL;
+    }
+
+  return self;
+}
+
+static void
+gxr_external_image_finalize (GObject *gobject)
+{
+  GxrExternalImage *self = GXR_EXTERNAL_IMAGE (gobject);
+
+  if (self->image_view != VK_NULL_HANDLE)
+    vkDestroyImageView (self->device, self->image_view, NULL);
+  if (self->image != VK_NULL_HANDLE)
+    vkDestroyImage (self->device, self->image, NULL);
+  if (self->memory != VK_NULL_HANDLE)
+    vkFreeMemory (self->device, self->memory, NULL);
+
+  g_clear_object (&self->context);
+
+  G_OBJECT_CLASS (gxr_external_image_parent_class)->finalize (gobject);
+}
+
+VkImage
+gxr_external_image_get_image (GxrExternalImage *self)
+{
+  return self->image;
+}
+
+VkImageView
+gxr_external_image_get_image_view (GxrExternalImage *self)
+{
+  return self->image_view;
+}
+
+VkExtent2D
+gxr_external_image_get_extent (GxrExternalImage *self)
+{
+  return self->extent;
+}
+
+static void
+_record_barrier (VkCommandBuffer      cmd_buffer,
+                 VkImage              image,
+                 VkImageLayout        old_layout,
+                 VkImageLayout        new_layout,
+                 uint32_t             src_family,
+                 uint32_t             dst_family,
+                 VkAccessFlags        src_access,
+                 VkAccessFlags        dst_access,
+                 VkPipelineStageFlags src_stage,
+                 VkPipelineStageFlags dst_stage)
+{
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = src_access,
+    .dstAccessMask = dst_access,
+    .oldLayout = old_layout,
+    .newLayout = new_layout,
+    .srcQueueFamilyIndex = src_family,
+    .dstQueueFamilyIndex = dst_family,
+    .image = image,
+    .subresourceRange = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .levelCount = 1,
+      .layerCount = 1,
+    },
+  };
+  vkCmdPipelineBarrier (cmd_buffer, src_stage, dst_stage, 0, 0, NULL, 0, NULL,
+                        1, &barrier);
+}
+
+static VkAccessFlags
+_get_access_for_layout (VkImageLayout layout)
+{
+  switch (layout)
+    {
+      case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        return VK_ACCESS_TRANSFER_READ_BIT;
+      case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        return VK_ACCESS_SHADER_READ_BIT;
+      default:
+        return VK_ACCESS_MEMORY_READ_BIT;
+    }
+}
+
+/*
+ * Records the acquire half of the ownership transfer from the external
+ * queue family, which is the only synchronization needed before reading
+ * the image. external_layout is the layout the producer left the image in,
+ * layout the one it is read in, for example
+ * VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL for sampling or
+ * VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL for
+ * gxr_external_image_record_blit_to_layer.
+ */
+void
+gxr_external_image_record_acquire (GxrExternalImage *self,
+                                   VkCommandBuffer   cmd_buffer,
+                                   VkImageLayout     external_layout,
+                                   VkImageLayout     layout)
+{
+  _record_barrier (cmd_buffer, self->image, external_layout, layout,
+                   VK_QUEUE_FAMILY_EXTERNAL, self->graphics_family, 0,
+                   _get_access_for_layout (layout),
+                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+  self->layout = layout;
+}
+
+/*
+ * Records handing the image back to the producer in external_layout, after
+ * it was last read in cmd_buffer in the layout given on acquire.
+ */
+void
+gxr_external_image_record_release (GxrExternalImage *self,
+                                   VkCommandBuffer   cmd_buffer,
+                                   VkImageLayout     external_layout)
+{
+  _record_barrier (cmd_buffer, self->image, self->layout, external_layout,
+                   self->graphics_family, VK_QUEUE_FAMILY_EXTERNAL, 0, 0,
+                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                   VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+/*
+ * Scales the image into the acquired image of layer on the GPU. The image
+ * needs to be acquired in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL.
+ * Returns FALSE if layer has no acquired image.
+ */
+gboolean
+gxr_external_image_record_blit_to_layer (GxrExternalImage *self,
+                                         VkCommandBuffer   cmd_buffer,
+                                         GxrLayer         *layer)
+{
+  VkImage layer_image = gxr_layer_get_acquired_image (layer);
+  if (layer_image == VK_NULL_HANDLE)
+    {
+      g_printerr ("Can only blit to an acquired layer image.\n");
+      return FALSE;
+    }
+
+  VkExtent2D layer_extent = gxr_layer_get_extent (layer);
+
+  /* layer images are acquired and released as color attachment */
+  _record_barrier (cmd_buffer, layer_image,
+                   VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, 0,
+                   VK_ACCESS_TRANSFER_WRITE_BIT,
+                   VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                   VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  VkImageBlit blit = {
+    .srcSubresource = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .layerCount = 1,
+    },
+    .srcOffsets = {
+      {0, 0, 0},
+      {(int32_t) self->extent.width, (int32_t) self->extent.height, 1},
+    },
+    .dstSubresource = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .layerCount = 1,
+    },
+    .dstOffsets = {
+      {0, 0, 0},
+      {(int32_t) layer_extent.width, (int32_t) layer_extent.height, 1},
+    },
+  };
+  vkCmdBlitImage (cmd_buffer, self->image,
+                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, layer_image,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                  VK_FILTER_LINEAR);
+
+  _record_barrier (cmd_buffer, layer_image,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                   VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                   VK_ACCESS_TRANSFER_WRITE_BIT,
+                   VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                   VK_PIPELINE_STAGE_TRANSFER_BIT,
+                   VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+  return TRUE;
+}
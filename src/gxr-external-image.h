@@ -0,0 +1,103 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_EXTERNAL_IMAGE_H_
+#define GXR_EXTERNAL_IMAGE_H_
+
+#if !defined(GXR_INSIDE) && !defined(GXR_COMPILATION)
+#error "Only <gxr.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gulkan.h>
+#include <stdint.h>
+
+#include "gxr-layer.h"
+
+G_BEGIN_DECLS
+
+#define GXR_TYPE_EXTERNAL_IMAGE gxr_external_image_get_type ()
+G_DECLARE_FINAL_TYPE (GxrExternalImage,
+                      gxr_external_image,
+                      GXR,
+                      EXTERNAL_IMAGE,
+                      GObject)
+
+/**
+ * GxrExternalHandleType:
+ * @GXR_EXTERNAL_HANDLE_OPAQUE_FD: An opaque fd exported by Vulkan on the same
+ *  device.
+ * @GXR_EXTERNAL_HANDLE_DMA_BUF: A dma-buf with a DRM format modifier.
+ *  Requires VK_EXT_external_memory_dma_buf and
+ *  VK_EXT_image_drm_format_modifier to be enabled on the device.
+ *
+ * The kind of fd an external image is imported from.
+ **/
+typedef enum
+{
+  GXR_EXTERNAL_HANDLE_OPAQUE_FD,
+  GXR_EXTERNAL_HANDLE_DMA_BUF,
+} GxrExternalHandleType;
+
+/**
+ * GxrExternalImageInfo:
+ * @fd: The fd of the memory, the image takes ownership of it.
+ * @handle_type: The kind of @fd.
+ * @extent: The size of the image.
+ * @format: The format of the image.
+ * @usage: The usage the image was created with by the producer.
+ * @allocation_size: The size of the exported memory allocation.
+ * @drm_format_modifier: The layout of a dma-buf.
+ * @offset: The offset of the first plane in a dma-buf.
+ * @row_pitch: The row pitch of the first plane in a dma-buf.
+ *
+ * Description of an image created by another process or API.
+ **/
+typedef struct
+{
+  int                   fd;
+  GxrExternalHandleType handle_type;
+  VkExtent2D            extent;
+  VkFormat              format;
+  VkImageUsageFlags     usage;
+  VkDeviceSize          allocation_size;
+  uint64_t              drm_format_modifier;
+  VkDeviceSize          offset;
+  VkDeviceSize          row_pitch;
+} GxrExternalImageInfo;
+
+GxrExternalImage *
+gxr_external_image_new_from_fd (GulkanContext              *context,
+                                const GxrExternalImageInfo *info);
+
+VkImage
+gxr_external_image_get_image (GxrExternalImage *self);
+
+VkImageView
+gxr_external_image_get_image_view (GxrExternalImage *self);
+
+VkExtent2D
+gxr_external_image_get_extent (GxrExternalImage *self);
+
+void
+gxr_external_image_record_acquire (GxrExternalImage *self,
+                                   VkCommandBuffer   cmd_buffer,
+                                   VkImageLayout     external_layout,
+                                   VkImageLayout     layout);
+
+void
+gxr_external_image_record_release (GxrExternalImage *self,
+                                   VkCommandBuffer   cmd_buffer,
+                                   VkImageLayout     external_layout);
+
+gboolean
+gxr_external_image_record_blit_to_layer (GxrExternalImage *self,
+                                         VkCommandBuffer   cmd_buffer,
+                                         GxrLayer         *layer);
+
+G_END_DECLS
+
+#endif /* GXR_EXTERNAL_IMAGE_H_ */
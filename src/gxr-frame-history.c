@@ -0,0 +1,193 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-frame-history.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define NSEC_PER_USEC 1000
+
+void
+gxr_frame_history_init (GxrFrameHistory *self)
+{
+  self->head = 0;
+  self->count = 0;
+  self->missed_frames = 0;
+}
+
+const GxrFrameTimestamps *
+gxr_frame_history_get_last (GxrFrameHistory *self)
+{
+  if (self->count == 0)
+    return NULL;
+
+  uint32_t last = (self->head + GXR_FRAME_HISTORY_SIZE - 1)
+                  % GXR_FRAME_HISTORY_SIZE;
+  return &self->frames[last];
+}
+
+/* Returns the number of display periods that were skipped before frame. */
+uint32_t
+gxr_frame_history_push (GxrFrameHistory          *self,
+                        const GxrFrameTimestamps *frame)
+{
+  uint32_t missed = 0;
+
+  const GxrFrameTimestamps *last = gxr_frame_history_get_last (self);
+  if (last && frame->predicted_display_period > 0)
+    {
+      int64_t delta = frame->predicted_display_time
+                      - last->predicted_display_time;
+      int64_t periods = (delta + frame->predicted_display_period / 2)
+                        / frame->predicted_display_period;
+      if (periods > 1)
+        missed = (uint32_t) (periods - 1);
+    }
+
+  self->missed_frames += missed;
+
+  self->frames[self->head] = *frame;
+  self->head = (self->head + 1) % GXR_FRAME_HISTORY_SIZE;
+  if (self->count < GXR_FRAME_HISTORY_SIZE)
+    self->count++;
+
+  return missed;
+}
+
+static int64_t
+_get_duration (const GxrFrameTimestamps *frame, GxrFramePhase phase)
+{
+  switch (phase)
+    {
+      case GXR_FRAME_PHASE_WAIT:
+        return frame->wait_end - frame->wait_start;
+      case GXR_FRAME_PHASE_BEGIN:
+        return frame->begin_end - frame->begin_start;
+      case GXR_FRAME_PHASE_RENDER:
+        return frame->end_start - frame->begin_end;
+      case GXR_FRAME_PHASE_END:
+        return frame->end_end - frame->end_start;
+      case GXR_FRAME_PHASE_GPU:
+        return frame->gpu_duration;
+      default:
+        return 0;
+    }
+}
+
+/* From begin frame until the end of the frame */
+static int64_t
+_get_work_duration (const GxrFrameTimestamps *frame)
+{
+  return frame->end_end - frame->begin_start;
+}
+
+static int
+_compare_int64 (const void *a, const void *b)
+{
+  int64_t x = *(const int64_t *) a;
+  int64_t y = *(const int64_t *) b;
+  return (x > y) - (x < y);
+}
+
+/* Frames without a reported GPU time are left out of the GPU phase. */
+static uint32_t
+_get_sorted_durations (GxrFrameHistory *self,
+                       GxrFramePhase    phase,
+                       int64_t         *durations)
+{
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < self->count; i++)
+    {
+      const GxrFrameTimestamps *frame = &self->frames[i];
+      if (phase == GXR_FRAME_PHASE_GPU && frame->gpu_duration <= 0)
+        continue;
+      durations[count++] = _get_duration (frame, phase);
+    }
+
+  qsort (durations, count, sizeof (int64_t), _compare_int64);
+  return count;
+}
+
+static uint32_t
+_get_sorted_work_durations (GxrFrameHistory *self, int64_t *durations)
+{
+  for (uint32_t i = 0; i < self->count; i++)
+    durations[i] = _get_work_duration (&self->frames[i]);
+
+  qsort (durations, self->count, sizeof (int64_t), _compare_int64);
+  return self->count;
+}
+
+static int64_t
+_percentile_of_sorted (const int64_t *sorted, uint32_t count, float percentile)
+{
+  if (count == 0)
+    return 0;
+
+  int64_t rank = (int64_t) ceilf (percentile * (float) count) - 1;
+  if (rank < 0)
+    rank = 0;
+  if (rank >= count)
+    rank = count - 1;
+
+  return sorted[rank];
+}
+
+int64_t
+gxr_frame_history_get_percentile (GxrFrameHistory *self,
+                                  GxrFramePhase    phase,
+                                  float            percentile)
+{
+  int64_t  durations[GXR_FRAME_HISTORY_SIZE];
+  uint32_t count = _get_sorted_durations (self, phase, durations);
+  return _percentile_of_sorted (durations, count, percentile);
+}
+
+int64_t
+gxr_frame_history_get_work_percentile (GxrFrameHistory *self,
+                                       float            percentile)
+{
+  int64_t  durations[GXR_FRAME_HISTORY_SIZE];
+  uint32_t count = _get_sorted_work_durations (self, durations);
+  return _percentile_of_sorted (durations, count, percentile);
+}
+
+static void
+_get_stats_of_sorted (const int64_t      *durations,
+                      uint32_t            count,
+                      GxrFramePhaseStats *stats)
+{
+  stats->p50 = _percentile_of_sorted (durations, count, 0.5f);
+  stats->p90 = _percentile_of_sorted (durations, count, 0.9f);
+  stats->p99 = _percentile_of_sorted (durations, count, 0.99f);
+  stats->max = count > 0 ? durations[count - 1] : 0;
+}
+
+void
+gxr_frame_history_get_stats (GxrFrameHistory *self, GxrFrameStats *stats)
+{
+  stats->frame_count = self->count;
+  stats->missed_frames = self->missed_frames;
+
+  const GxrFrameTimestamps *last = gxr_frame_history_get_last (self);
+  stats->predicted_display_period = last ? last->predicted_display_period
+                                             / NSEC_PER_USEC
+                                         : 0;
+
+  int64_t  durations[GXR_FRAME_HISTORY_SIZE];
+  uint32_t count;
+  for (uint32_t i = 0; i < GXR_FRAME_PHASE_LAST; i++)
+    {
+      count = _get_sorted_durations (self, (GxrFramePhase) i, durations);
+      _get_stats_of_sorted (durations, count, &stats->phases[i]);
+    }
+
+  count = _get_sorted_work_durations (self, durations);
+  _get_stats_of_sorted (durations, count, &stats->work);
+
+  stats->remaining_budget = stats->predicted_display_period - stats->work.p90;
+}
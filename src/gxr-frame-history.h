@@ -0,0 +1,65 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_FRAME_HISTORY_H_
+#define GXR_FRAME_HISTORY_H_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "gxr-context.h"
+
+#define GXR_FRAME_HISTORY_SIZE 128
+
+/* Monotonic timestamps in microseconds, display times in nanoseconds */
+typedef struct
+{
+  int64_t wait_start;
+  int64_t wait_end;
+  int64_t begin_start;
+  int64_t begin_end;
+  int64_t end_start;
+  int64_t end_end;
+
+  /* reported by the application, 0 if unknown */
+  int64_t gpu_duration;
+
+  int64_t predicted_display_time;
+  int64_t predicted_display_period;
+} GxrFrameTimestamps;
+
+typedef struct
+{
+  GxrFrameTimestamps frames[GXR_FRAME_HISTORY_SIZE];
+  /* index of the next frame to be written */
+  uint32_t head;
+  uint32_t count;
+  uint64_t missed_frames;
+} GxrFrameHistory;
+
+void
+gxr_frame_history_init (GxrFrameHistory *self);
+
+uint32_t
+gxr_frame_history_push (GxrFrameHistory          *self,
+                        const GxrFrameTimestamps *frame);
+
+const GxrFrameTimestamps *
+gxr_frame_history_get_last (GxrFrameHistory *self);
+
+int64_t
+gxr_frame_history_get_percentile (GxrFrameHistory *self,
+                                  GxrFramePhase    phase,
+                                  float            percentile);
+
+int64_t
+gxr_frame_history_get_work_percentile (GxrFrameHistory *self,
+                                       float            percentile);
+
+void
+gxr_frame_history_get_stats (GxrFrameHistory *self, GxrFrameStats *stats);
+
+#endif /* GXR_FRAME_HISTORY_H_ */
@@ -0,0 +1,56 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_LAYER_PRIVATE_H_
+#define GXR_LAYER_PRIVATE_H_
+
+#include <openxr/openxr.h>
+
+#include "gxr-context.h"
+#include "gxr-layer.h"
+
+gboolean
+gxr_layer_initialize (GxrLayer   *self,
+                      GxrContext *context,
+                      VkExtent2D  extent,
+                      VkFormat    format,
+                      gboolean    static_image,
+                      uint32_t    mip_count);
+
+GxrContext *
+gxr_layer_get_context (GxrLayer *self);
+
+gboolean
+gxr_layer_is_submittable (GxrLayer *self);
+
+gboolean
+gxr_layer_take_updated (GxrLayer *self);
+
+void
+gxr_layer_set_demoted (GxrLayer *self, gboolean demoted);
+
+void
+gxr_layer_set_atlas_rect (GxrLayer *self, const VkRect2D *rect);
+
+const XrCompositionLayerBaseHeader *
+gxr_layer_get_composition_layer (GxrLayer *self);
+
+XrSpace
+gxr_layer_get_xr_space (GxrLayer *self);
+
+XrPosef
+gxr_layer_get_xr_pose (GxrLayer *self);
+
+XrSwapchainSubImage
+gxr_layer_get_sub_image (GxrLayer *self);
+
+VkImage
+gxr_layer_get_acquired_image (GxrLayer *self);
+
+VkImage
+gxr_layer_get_released_image (GxrLayer *self);
+
+#endif /* GXR_LAYER_PRIVATE_H_ */
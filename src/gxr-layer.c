@@ -0,0 +1,728 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-layer-private.h"
+
+#define XR_USE_GRAPHICS_API_VULKAN 1
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#include <math.h>
+
+#include "graphene-ext.h"
+#include "gxr-context-private.h"
+
+#define NANO_TO_MILLI 1000000
+
+typedef struct _GxrLayerPrivate
+{
+  GObject parent;
+
+  GxrContext *context;
+
+  XrSwapchain                handle;
+  XrSwapchainImageVulkanKHR *images;
+  uint32_t                   image_count;
+  VkExtent2D                 extent;
+  VkFormat                   format;
+  uint32_t                   mip_count;
+  /* image acquired for rendering, or -1 */
+  int64_t acquired_index;
+  /* last released image, or -1 */
+  int64_t released_index;
+
+  /* an image was released, so the swapchain has content to show */
+  gboolean has_content;
+  /* the content needs to be rendered again */
+  gboolean dirty;
+  /* an image was released since the last submitted frame */
+  gboolean updated;
+  /* the content can only be rendered once */
+  gboolean static_image;
+
+  XrPosef           pose;
+  graphene_matrix_t pose_matrix;
+  GxrLayerSpace     space;
+  gboolean          visible;
+  int32_t           order;
+  int32_t           priority;
+
+  /* over the layer budget, the content is copied into the layer atlas */
+  gboolean demoted;
+  gboolean in_atlas;
+  VkRect2D atlas_rect;
+} GxrLayerPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GxrLayer, gxr_layer, G_TYPE_OBJECT)
+
+static void
+gxr_layer_finalize (GObject *gobject);
+
+static void
+gxr_layer_class_init (GxrLayerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  object_class->finalize = gxr_layer_finalize;
+}
+
+static void
+gxr_layer_init (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  priv->context = NULL;
+  priv->handle = XR_NULL_HANDLE;
+  priv->images = NULL;
+  priv->image_count = 0;
+  priv->mip_count = 1;
+  priv->acquired_index = -1;
+  priv->released_index = -1;
+  priv->has_content = FALSE;
+  priv->dirty = TRUE;
+  priv->updated = FALSE;
+  priv->static_image = FALSE;
+  priv->pose = (XrPosef){
+    .orientation = {.w = 1.0f},
+  };
+  graphene_matrix_init_identity (&priv->pose_matrix);
+  priv->space = GXR_LAYER_SPACE_PLAY;
+  priv->visible = TRUE;
+  priv->order = 0;
+  priv->priority = 0;
+  priv->demoted = FALSE;
+  priv->in_atlas = FALSE;
+  priv->atlas_rect = (VkRect2D){0};
+}
+
+static void
+_printerr_xr_result (XrInstance instance, XrResult result)
+{
+  char buffer[XR_MAX_RESULT_STRING_SIZE];
+  xrResultToString (instance, result, buffer);
+  g_printerr ("%s\n", buffer);
+}
+
+static gboolean
+_create_swapchain (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  XrInstance       instance = gxr_context_get_openxr_instance (priv->context);
+
+  /* the first level is blitted into the mip chain and the layer atlas */
+  XrSwapchainUsageFlags usage = XR_SWAPCHAIN_USAGE_SAMPLED_BIT
+                                | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT
+                                | XR_SWAPCHAIN_USAGE_TRANSFER_SRC_BIT
+                                | XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT;
+
+  XrSwapchainCreateInfo info = {
+    .type = XR_TYPE_SWAPCHAIN_CREATE_INFO,
+    .createFlags = priv->static_image ? XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT
+                                      : 0,
+    .usageFlags = usage,
+    .format = priv->format,
+    .sampleCount = 1,
+    .width = priv->extent.width,
+    .height = priv->extent.height,
+    .faceCount = 1,
+    .arraySize = 1,
+    .mipCount = priv->mip_count,
+  };
+
+  XrSession session = gxr_context_get_openxr_session (priv->context);
+  XrResult  result = xrCreateSwapchain (session, &info, &priv->handle);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to create layer swapchain: ");
+      _printerr_xr_result (instance, result);
+      return FALSE;
+    }
+
+  result = xrEnumerateSwapchainImages (priv->handle, 0, &priv->image_count,
+                                       NULL);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to enumerate layer swapchain images: ");
+      _printerr_xr_result (instance, result);
+      return FALSE;
+    }
+
+  priv->images = g_malloc (sizeof (XrSwapchainImageVulkanKHR)
+                           * priv->image_count);
+  for (uint32_t i = 0; i < priv->image_count; i++)
+    priv->images[i] = (XrSwapchainImageVulkanKHR){
+      .type = XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR,
+    };
+
+  result = xrEnumerateSwapchainImages (priv->handle, priv->image_count,
+                                       &priv->image_count,
+                                       (XrSwapchainImageBaseHeader *)
+                                         priv->images);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to enumerate layer swapchain images: ");
+      _printerr_xr_result (instance, result);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static uint32_t
+_get_max_mip_count (VkExtent2D extent)
+{
+  return (uint32_t) floorf (log2f ((float) MAX (extent.width, extent.height)))
+         + 1;
+}
+
+static gboolean
+_supports_mip_generation (GxrContext *context, VkFormat format)
+{
+  GulkanDevice *device = gulkan_context_get_device (
+    gxr_context_get_gulkan (context));
+  VkPhysicalDevice physical_device = gulkan_device_get_physical_handle (device);
+
+  VkFormatProperties properties;
+  vkGetPhysicalDeviceFormatProperties (physical_device, format, &properties);
+
+  VkFormatFeatureFlags required
+    = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+      | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+  return (properties.optimalTilingFeatures & required) == required;
+}
+
+/*
+ * A mip_count of 0 creates the full mip chain, it is limited to the full
+ * chain and to 1 when the format can not be blitted linearly.
+ */
+gboolean
+gxr_layer_initialize (GxrLayer   *self,
+                      GxrContext *context,
+                      VkExtent2D  extent,
+                      VkFormat    format,
+                      gboolean    static_image,
+                      uint32_t    mip_count)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  priv->context = g_object_ref (context);
+  priv->extent = extent;
+  priv->format = format;
+  priv->static_image = static_image;
+
+  uint32_t max_mip_count = _get_max_mip_count (extent);
+  priv->mip_count = mip_count == 0 ? max_mip_count
+                                   : MIN (mip_count, max_mip_count);
+  if (priv->mip_count > 1 && !_supports_mip_generation (context, format))
+    {
+      g_warning ("Format %d does not support mip generation.", format);
+      priv->mip_count = 1;
+    }
+
+  if (!_create_swapchain (self))
+    return FALSE;
+
+  gxr_context_add_layer (context, self);
+
+  return TRUE;
+}
+
+static void
+gxr_layer_finalize (GObject *gobject)
+{
+  GxrLayer        *self = GXR_LAYER (gobject);
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+
+  if (priv->context)
+    {
+      gxr_context_remove_layer (priv->context, self);
+      g_clear_object (&priv->context);
+    }
+
+  if (priv->handle != XR_NULL_HANDLE)
+    xrDestroySwapchain (priv->handle);
+  g_free (priv->images);
+
+  G_OBJECT_CLASS (gxr_layer_parent_class)->finalize (gobject);
+}
+
+GxrContext *
+gxr_layer_get_context (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->context;
+}
+
+/*
+ * Acquires the next swapchain image to render the layer content into and
+ * waits until it can be written. Layers are resubmitted with their last
+ * released image, so this is only needed when the layer is dirty.
+ */
+gboolean
+gxr_layer_acquire (GxrLayer *self, uint32_t *index)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  XrInstance       instance = gxr_context_get_openxr_instance (priv->context);
+
+  if (priv->static_image && priv->has_content)
+    {
+      g_printerr ("Static layer content can only be rendered once.\n");
+      return FALSE;
+    }
+
+  XrSwapchainImageAcquireInfo acquire_info = {
+    .type = XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO,
+  };
+  XrResult result = xrAcquireSwapchainImage (priv->handle, &acquire_info,
+                                             index);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to acquire layer image: ");
+      _printerr_xr_result (instance, result);
+      return FALSE;
+    }
+
+  XrSwapchainImageWaitInfo wait_info = {
+    .type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO,
+    .timeout = 100 * NANO_TO_MILLI,
+  };
+  while ((result = xrWaitSwapchainImage (priv->handle, &wait_info))
+         == XR_TIMEOUT_EXPIRED)
+    g_warning ("Waiting for layer image timed out after 100 ms...");
+
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to wait for layer image: ");
+      _printerr_xr_result (instance, result);
+      return FALSE;
+    }
+
+  priv->acquired_index = *index;
+
+  return TRUE;
+}
+
+/* The released image is shown from the next gxr_context_end_frame on. */
+gboolean
+gxr_layer_release (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+
+  XrSwapchainImageReleaseInfo release_info = {
+    .type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO,
+  };
+  XrResult result = xrReleaseSwapchainImage (priv->handle, &release_info);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to release layer image: ");
+      _printerr_xr_result (gxr_context_get_openxr_instance (priv->context),
+                           result);
+      return FALSE;
+    }
+
+  priv->has_content = TRUE;
+  priv->dirty = FALSE;
+  priv->updated = TRUE;
+  priv->released_index = priv->acquired_index;
+  priv->acquired_index = -1;
+  return TRUE;
+}
+
+/* Returns VK_NULL_HANDLE if no image is acquired. */
+VkImage
+gxr_layer_get_acquired_image (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  if (priv->acquired_index < 0)
+    return VK_NULL_HANDLE;
+  return priv->images[priv->acquired_index].image;
+}
+
+/*
+ * The image with the shown content, in
+ * VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL. Returns VK_NULL_HANDLE if no
+ * image was released yet.
+ */
+VkImage
+gxr_layer_get_released_image (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  if (priv->released_index < 0)
+    return VK_NULL_HANDLE;
+  return priv->images[priv->released_index].image;
+}
+
+uint32_t
+gxr_layer_get_mip_count (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->mip_count;
+}
+
+static void
+_record_mip_barrier (VkCommandBuffer      cmd_buffer,
+                     VkImage              image,
+                     uint32_t             mip_level,
+                     uint32_t             level_count,
+                     VkImageLayout        old_layout,
+                     VkImageLayout        new_layout,
+                     VkAccessFlags        src_access,
+                     VkAccessFlags        dst_access,
+                     VkPipelineStageFlags src_stage,
+                     VkPipelineStageFlags dst_stage)
+{
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = src_access,
+    .dstAccessMask = dst_access,
+    .oldLayout = old_layout,
+    .newLayout = new_layout,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel = mip_level,
+      .levelCount = level_count,
+      .baseArrayLayer = 0,
+      .layerCount = 1,
+    },
+  };
+  vkCmdPipelineBarrier (cmd_buffer, src_stage, dst_stage, 0, 0, NULL, 0, NULL,
+                        1, &barrier);
+}
+
+/*
+ * Records blits that generate the mip chain of the acquired image from its
+ * first level, after the content was rendered in cmd_buffer. Clean layers
+ * are not acquired, so only changed content is processed.
+ * The image is in VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL before and
+ * after, as expected by the runtime.
+ * Returns FALSE if no image is acquired.
+ */
+gboolean
+gxr_layer_record_mip_generation (GxrLayer *self, VkCommandBuffer cmd_buffer)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+
+  if (priv->acquired_index < 0)
+    {
+      g_printerr ("Mips can only be generated for an acquired layer image.\n");
+      return FALSE;
+    }
+
+  if (priv->mip_count < 2)
+    return TRUE;
+
+  VkImage image = priv->images[priv->acquired_index].image;
+
+  _record_mip_barrier (cmd_buffer, image, 0, 1,
+                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                       VK_ACCESS_TRANSFER_READ_BIT,
+                       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  int32_t width = (int32_t) priv->extent.width;
+  int32_t height = (int32_t) priv->extent.height;
+
+  for (uint32_t level = 1; level < priv->mip_count; level++)
+    {
+      int32_t level_width = MAX (width / 2, 1);
+      int32_t level_height = MAX (height / 2, 1);
+
+      /* previous content of the level is overwritten */
+      _record_mip_barrier (cmd_buffer, image, level, 1,
+                           VK_IMAGE_LAYOUT_UNDEFINED,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                           VK_ACCESS_TRANSFER_WRITE_BIT,
+                           VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+      VkImageBlit blit = {
+        .srcSubresource = {
+          .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+          .mipLevel = level - 1,
+          .layerCount = 1,
+        },
+        .srcOffsets = {{0, 0, 0}, {width, height, 1}},
+        .dstSubresource = {
+          .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+          .mipLevel = level,
+          .layerCount = 1,
+        },
+        .dstOffsets = {{0, 0, 0}, {level_width, level_height, 1}},
+      };
+      vkCmdBlitImage (cmd_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                      image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                      VK_FILTER_LINEAR);
+
+      _record_mip_barrier (cmd_buffer, image, level, 1,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           VK_ACCESS_TRANSFER_WRITE_BIT,
+                           VK_ACCESS_TRANSFER_READ_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+      width = level_width;
+      height = level_height;
+    }
+
+  _record_mip_barrier (cmd_buffer, image, 0, priv->mip_count,
+                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                       VK_ACCESS_TRANSFER_READ_BIT,
+                       VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+  return TRUE;
+}
+
+/* Flags the content to be rendered again, new layers start dirty. */
+void
+gxr_layer_mark_dirty (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  priv->dirty = TRUE;
+}
+
+gboolean
+gxr_layer_is_dirty (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->dirty;
+}
+
+gboolean
+gxr_layer_is_static (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->static_image;
+}
+
+/* Returns if an image was released since the last call. */
+gboolean
+gxr_layer_take_updated (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  gboolean         updated = priv->updated;
+  priv->updated = FALSE;
+  return updated;
+}
+
+VkImage
+gxr_layer_get_image (GxrLayer *self, uint32_t index)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->images[index].image;
+}
+
+uint32_t
+gxr_layer_get_image_count (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->image_count;
+}
+
+VkExtent2D
+gxr_layer_get_extent (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->extent;
+}
+
+VkFormat
+gxr_layer_get_format (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->format;
+}
+
+/* Sets the pose from a transformation without scale. */
+void
+gxr_layer_set_pose (GxrLayer *self, graphene_matrix_t *pose)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+
+  graphene_point3d_t    scale;
+  graphene_quaternion_t orientation;
+  graphene_ext_matrix_get_rotation_quaternion (pose, &scale, &orientation);
+
+  graphene_point3d_t position;
+  graphene_ext_matrix_get_translation_point3d (pose, &position);
+
+  float q[4];
+  graphene_ext_quaternion_to_float (&orientation, q);
+
+  priv->pose = (XrPosef){
+    .orientation = {q[0], q[1], q[2], q[3]},
+    .position = {position.x, position.y, position.z},
+  };
+  graphene_matrix_init_from_matrix (&priv->pose_matrix, pose);
+}
+
+void
+gxr_layer_get_pose (GxrLayer *self, graphene_matrix_t *pose)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  graphene_matrix_init_from_matrix (pose, &priv->pose_matrix);
+}
+
+void
+gxr_layer_set_space (GxrLayer *self, GxrLayerSpace space)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  priv->space = space;
+}
+
+GxrLayerSpace
+gxr_layer_get_space (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->space;
+}
+
+void
+gxr_layer_set_visible (GxrLayer *self, gboolean visible)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  priv->visible = visible;
+}
+
+gboolean
+gxr_layer_is_visible (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->visible;
+}
+
+/*
+ * Layers are submitted in ascending order, later layers are composited on
+ * top. Layers with a negative order are composited below the projection
+ * layer.
+ */
+void
+gxr_layer_set_order (GxrLayer *self, int32_t order)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  priv->order = order;
+}
+
+int32_t
+gxr_layer_get_order (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->order;
+}
+
+/*
+ * When the runtime can not show all layers, the ones with the highest
+ * priority keep being submitted and the rest is demoted.
+ */
+void
+gxr_layer_set_priority (GxrLayer *self, int32_t priority)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  priv->priority = priority;
+}
+
+int32_t
+gxr_layer_get_priority (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->priority;
+}
+
+/*
+ * Demoted layers are not submitted on their own. The context copies their
+ * last released image into the layer atlas, which is submitted as one quad,
+ * see gxr_layer_get_atlas_rect.
+ */
+gboolean
+gxr_layer_is_demoted (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->demoted;
+}
+
+/*
+ * The rect of a demoted layer in the layer atlas of the context. Returns
+ * FALSE if the layer has no space in the atlas, then it is not shown.
+ */
+gboolean
+gxr_layer_get_atlas_rect (GxrLayer *self, VkRect2D *rect)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  if (!priv->in_atlas)
+    return FALSE;
+  *rect = priv->atlas_rect;
+  return TRUE;
+}
+
+void
+gxr_layer_set_demoted (GxrLayer *self, gboolean demoted)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  priv->demoted = demoted;
+}
+
+/* Moves the layer in the atlas, rect NULL removes it from the atlas. */
+void
+gxr_layer_set_atlas_rect (GxrLayer *self, const VkRect2D *rect)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  priv->in_atlas = rect != NULL;
+  priv->atlas_rect = rect ? *rect : (VkRect2D){0};
+}
+
+gboolean
+gxr_layer_is_submittable (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->visible && priv->has_content && !priv->demoted;
+}
+
+const XrCompositionLayerBaseHeader *
+gxr_layer_get_composition_layer (GxrLayer *self)
+{
+  GxrLayerClass *klass = GXR_LAYER_GET_CLASS (self);
+  if (klass->get_composition_layer == NULL)
+    return NULL;
+  return klass->get_composition_layer (self);
+}
+
+XrSpace
+gxr_layer_get_xr_space (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  if (priv->space == GXR_LAYER_SPACE_VIEW)
+    return gxr_context_get_view_space (priv->context);
+  return gxr_context_get_tracked_space (priv->context);
+}
+
+XrPosef
+gxr_layer_get_xr_pose (GxrLayer *self)
+{
+  GxrLayerPrivate *priv = gxr_layer_get_instance_private (self);
+  return priv->pose;
+}
+
+XrSwapchainSubImage
+gxr_layer_get_sub_image (GxrLayer *self)
+{
+  GxrLayerPrivate    *priv = gxr_layer_get_instance_private (self);
+  XrSwapchainSubImage sub_image = {
+    .swapchain = priv->handle,
+    .imageRect = {
+      .extent = {
+        .width = (int32_t) priv->extent.width,
+        .height = (int32_t) priv->extent.height,
+      },
+    },
+    .imageArrayIndex = 0,
+  };
+  return sub_image;
+}
@@ -0,0 +1,123 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_LAYER_H_
+#define GXR_LAYER_H_
+
+#if !defined(GXR_INSIDE) && !defined(GXR_COMPILATION)
+#error "Only <gxr.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <graphene.h>
+#include <gulkan.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+#define GXR_TYPE_LAYER gxr_layer_get_type ()
+G_DECLARE_DERIVABLE_TYPE (GxrLayer, gxr_layer, GXR, LAYER, GObject)
+
+/**
+ * GxrLayerClass:
+ * @parent: The parent class
+ * @get_composition_layer: Updates and returns the layer struct of the
+ *  subclass, starting with an XrCompositionLayerBaseHeader.
+ */
+struct _GxrLayerClass
+{
+  GObjectClass parent;
+
+  const void *(*get_composition_layer) (GxrLayer *self);
+};
+
+/**
+ * GxrLayerSpace:
+ * @GXR_LAYER_SPACE_PLAY: The layer pose is relative to the tracked play
+ *  space, the layer stays in place in the world.
+ * @GXR_LAYER_SPACE_VIEW: The layer pose is relative to the head, the layer
+ *  follows the head.
+ *
+ * The space the layer pose is given in.
+ **/
+typedef enum
+{
+  GXR_LAYER_SPACE_PLAY,
+  GXR_LAYER_SPACE_VIEW,
+} GxrLayerSpace;
+
+gboolean
+gxr_layer_acquire (GxrLayer *self, uint32_t *index);
+
+void
+gxr_layer_mark_dirty (GxrLayer *self);
+
+gboolean
+gxr_layer_is_dirty (GxrLayer *self);
+
+gboolean
+gxr_layer_is_static (GxrLayer *self);
+
+gboolean
+gxr_layer_release (GxrLayer *self);
+
+uint32_t
+gxr_layer_get_mip_count (GxrLayer *self);
+
+gboolean
+gxr_layer_record_mip_generation (GxrLayer *self, VkCommandBuffer cmd_buffer);
+
+VkImage
+gxr_layer_get_image (GxrLayer *self, uint32_t index);
+
+uint32_t
+gxr_layer_get_image_count (GxrLayer *self);
+
+VkExtent2D
+gxr_layer_get_extent (GxrLayer *self);
+
+VkFormat
+gxr_layer_get_format (GxrLayer *self);
+
+void
+gxr_layer_set_pose (GxrLayer *self, graphene_matrix_t *pose);
+
+void
+gxr_layer_get_pose (GxrLayer *self, graphene_matrix_t *pose);
+
+void
+gxr_layer_set_space (GxrLayer *self, GxrLayerSpace space);
+
+GxrLayerSpace
+gxr_layer_get_space (GxrLayer *self);
+
+void
+gxr_layer_set_visible (GxrLayer *self, gboolean visible);
+
+gboolean
+gxr_layer_is_visible (GxrLayer *self);
+
+void
+gxr_layer_set_order (GxrLayer *self, int32_t order);
+
+int32_t
+gxr_layer_get_order (GxrLayer *self);
+
+void
+gxr_layer_set_priority (GxrLayer *self, int32_t priority);
+
+int32_t
+gxr_layer_get_priority (GxrLayer *self);
+
+gboolean
+gxr_layer_is_demoted (GxrLayer *self);
+
+gboolean
+gxr_layer_get_atlas_rect (GxrLayer *self, VkRect2D *rect);
+
+G_END_DECLS
+
+#endif /* GXR_LAYER_H_ */
@@ -0,0 +1,74 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-pose-service.h"
+
+#include <stdatomic.h>
+
+void
+gxr_pose_service_init (GxrPoseService *self)
+{
+  *self = (GxrPoseService){0};
+}
+
+/* Only one thread may write. */
+void
+gxr_pose_service_begin_write (GxrPoseService *self, int64_t time)
+{
+  g_atomic_int_inc (&self->sequence);
+  /* readers that see the relations of this write see the odd sequence */
+  atomic_thread_fence (memory_order_release);
+  self->time = time;
+}
+
+void
+gxr_pose_service_write (GxrPoseService         *self,
+                        uint32_t                slot,
+                        const GxrSpaceRelation *relation)
+{
+  if (slot < GXR_POSE_SERVICE_MAX_SLOTS)
+    self->relations[slot] = *relation;
+}
+
+void
+gxr_pose_service_end_write (GxrPoseService *self)
+{
+  atomic_thread_fence (memory_order_release);
+  g_atomic_int_inc (&self->sequence);
+}
+
+/*
+ * Copies the relation in slot and the time it was located at. Never blocks
+ * the writer, but retries while it overlaps with a write.
+ */
+gboolean
+gxr_pose_service_read (GxrPoseService   *self,
+                       uint32_t          slot,
+                       GxrSpaceRelation *relation,
+                       int64_t          *time)
+{
+  if (slot >= GXR_POSE_SERVICE_MAX_SLOTS)
+    return FALSE;
+
+  gint begin;
+  gint end = 0;
+  do
+    {
+      begin = g_atomic_int_get (&self->sequence);
+      if (begin & 1)
+        continue;
+
+      *relation = self->relations[slot];
+      *time = self->time;
+
+      atomic_thread_fence (memory_order_acquire);
+      end = g_atomic_int_get (&self->sequence);
+    }
+  while ((begin & 1) || begin != end);
+
+  /* nothing was published yet */
+  return *time != 0;
+}
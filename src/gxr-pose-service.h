@@ -0,0 +1,52 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_POSE_SERVICE_H_
+#define GXR_POSE_SERVICE_H_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "gxr-space-locator.h"
+
+/* Slots of the space locator beyond this are not published */
+#define GXR_POSE_SERVICE_MAX_SLOTS 32
+
+/*
+ * The relations of the registered spaces located last, written by the frame
+ * loop and read by any thread without locking. The sequence is odd while a
+ * write is in progress, readers retry when it changed during their copy.
+ */
+typedef struct
+{
+  gint sequence;
+
+  /* monotonic time in microseconds the relations were located at */
+  int64_t          time;
+  GxrSpaceRelation relations[GXR_POSE_SERVICE_MAX_SLOTS];
+} GxrPoseService;
+
+void
+gxr_pose_service_init (GxrPoseService *self);
+
+void
+gxr_pose_service_begin_write (GxrPoseService *self, int64_t time);
+
+void
+gxr_pose_service_write (GxrPoseService         *self,
+                        uint32_t                slot,
+                        const GxrSpaceRelation *relation);
+
+void
+gxr_pose_service_end_write (GxrPoseService *self);
+
+gboolean
+gxr_pose_service_read (GxrPoseService   *self,
+                       uint32_t          slot,
+                       GxrSpaceRelation *relation,
+                       int64_t          *time);
+
+#endif /* GXR_POSE_SERVICE_H_ */
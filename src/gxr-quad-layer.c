@@ -0,0 +1,118 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-quad-layer.h"
+
+#include "gxr-layer-private.h"
+
+struct _GxrQuadLayer
+{
+  GxrLayer parent;
+
+  XrCompositionLayerQuad layer;
+};
+
+G_DEFINE_TYPE (GxrQuadLayer, gxr_quad_layer, GXR_TYPE_LAYER)
+
+static const void *
+_get_composition_layer (GxrLayer *layer)
+{
+  GxrQuadLayer *self = GXR_QUAD_LAYER (layer);
+
+  self->layer.space = gxr_layer_get_xr_space (layer);
+  self->layer.pose = gxr_layer_get_xr_pose (layer);
+  self->layer.subImage = gxr_layer_get_sub_image (layer);
+
+  return &self->layer;
+}
+
+static void
+gxr_quad_layer_class_init (GxrQuadLayerClass *klass)
+{
+  GxrLayerClass *layer_class = GXR_LAYER_CLASS (klass);
+  layer_class->get_composition_layer = _get_composition_layer;
+}
+
+static void
+gxr_quad_layer_init (GxrQuadLayer *self)
+{
+  self->layer = (XrCompositionLayerQuad){
+    .type = XR_TYPE_COMPOSITION_LAYER_QUAD,
+    .layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
+    .eyeVisibility = XR_EYE_VISIBILITY_BOTH,
+    .size = {1.0f, 1.0f},
+  };
+}
+
+static GxrQuadLayer *
+_new (GxrContext *context,
+      VkExtent2D  extent,
+      VkFormat    format,
+      gboolean    static_image,
+      uint32_t    mip_count)
+{
+  GxrQuadLayer *self = (GxrQuadLayer *) g_object_new (GXR_TYPE_QUAD_LAYER, 0);
+
+  if (!gxr_layer_initialize (GXR_LAYER (self), context, extent, format,
+                             static_image, mip_count))
+    {
+      g_object_unref (self);
+      return NULL;
+    }
+
+  return self;
+}
+
+/*
+ * Creates a quad layer with its own swapchain of the given extent and
+ * format. The quad is 1x1 meters, facing +Z at the origin of the play
+ * space until a size and pose are set.
+ */
+GxrQuadLayer *
+gxr_quad_layer_new (GxrContext *context, VkExtent2D extent, VkFormat format)
+{
+  return _new (context, extent, format, FALSE, 1);
+}
+
+/*
+ * Creates a quad layer with mip_count levels, or the full mip chain for 0,
+ * so distant quads are sampled at a matching resolution. The levels are
+ * generated with gxr_layer_record_mip_generation after rendering.
+ */
+GxrQuadLayer *
+gxr_quad_layer_new_mipmapped (GxrContext *context,
+                              VkExtent2D  extent,
+                              VkFormat    format,
+                              uint32_t    mip_count)
+{
+  return _new (context, extent, format, FALSE, mip_count);
+}
+
+/*
+ * Creates a quad layer for content that never changes. Its swapchain has a
+ * single image, which is rendered once.
+ */
+GxrQuadLayer *
+gxr_quad_layer_new_static (GxrContext *context,
+                           VkExtent2D  extent,
+                           VkFormat    format)
+{
+  return _new (context, extent, format, TRUE, 1);
+}
+
+/* Size of the quad in meters. */
+void
+gxr_quad_layer_set_size (GxrQuadLayer *self, float width, float height)
+{
+  self->layer.size = (XrExtent2Df){width, height};
+}
+
+void
+gxr_quad_layer_get_size (GxrQuadLayer *self, float *width, float *height)
+{
+  *width = self->layer.size.width;
+  *height = self->layer.size.height;
+}
@@ -0,0 +1,46 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_QUAD_LAYER_H_
+#define GXR_QUAD_LAYER_H_
+
+#if !defined(GXR_INSIDE) && !defined(GXR_COMPILATION)
+#error "Only <gxr.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+
+#include "gxr-context.h"
+#include "gxr-layer.h"
+
+G_BEGIN_DECLS
+
+#define GXR_TYPE_QUAD_LAYER gxr_quad_layer_get_type ()
+G_DECLARE_FINAL_TYPE (GxrQuadLayer, gxr_quad_layer, GXR, QUAD_LAYER, GxrLayer)
+
+GxrQuadLayer *
+gxr_quad_layer_new (GxrContext *context, VkExtent2D extent, VkFormat format);
+
+GxrQuadLayer *
+gxr_quad_layer_new_mipmapped (GxrContext *context,
+                              VkExtent2D  extent,
+                              VkFormat    format,
+                              uint32_t    mip_count);
+
+GxrQuadLayer *
+gxr_quad_layer_new_static (GxrContext *context,
+                           VkExtent2D  extent,
+                           VkFormat    format);
+
+void
+gxr_quad_layer_set_size (GxrQuadLayer *self, float width, float height);
+
+void
+gxr_quad_layer_get_size (GxrQuadLayer *self, float *width, float *height);
+
+G_END_DECLS
+
+#endif /* GXR_QUAD_LAYER_H_ */
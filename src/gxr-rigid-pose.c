@@ -0,0 +1,138 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-rigid-pose.h"
+
+/* Hamilton product, res rotates by b first and by a second. */
+static void
+_quaternion_multiply (const graphene_quaternion_t *a,
+                      const graphene_quaternion_t *b,
+                      graphene_quaternion_t       *res)
+{
+  float           qa[4];
+  float           qb[4];
+  graphene_vec4_t v;
+  graphene_quaternion_to_vec4 (a, &v);
+  graphene_vec4_to_float (&v, qa);
+  graphene_quaternion_to_vec4 (b, &v);
+  graphene_vec4_to_float (&v, qb);
+
+  graphene_quaternion_init (res,
+                            qa[3] * qb[0] + qa[0] * qb[3] + qa[1] * qb[2]
+                              - qa[2] * qb[1],
+                            qa[3] * qb[1] - qa[0] * qb[2] + qa[1] * qb[3]
+                              + qa[2] * qb[0],
+                            qa[3] * qb[2] + qa[0] * qb[1] - qa[1] * qb[0]
+                              + qa[2] * qb[3],
+                            qa[3] * qb[3] - qa[0] * qb[0] - qa[1] * qb[1]
+                              - qa[2] * qb[2]);
+}
+
+/* v + w t + u x t with t = 2 u x v, for the unit quaternion (u, w). */
+static void
+_rotate_vec3 (const graphene_quaternion_t *q,
+              const graphene_vec3_t       *v,
+              graphene_vec3_t             *res)
+{
+  graphene_vec4_t q4;
+  graphene_quaternion_to_vec4 (q, &q4);
+
+  graphene_vec3_t u;
+  graphene_vec4_get_xyz (&q4, &u);
+
+  graphene_vec3_t t;
+  graphene_vec3_cross (&u, v, &t);
+  graphene_vec3_scale (&t, 2.0f, &t);
+
+  graphene_vec3_t u_cross_t;
+  graphene_vec3_cross (&u, &t, &u_cross_t);
+  graphene_vec3_scale (&t, graphene_vec4_get_w (&q4), &t);
+
+  graphene_vec3_add (v, &t, res);
+  graphene_vec3_add (res, &u_cross_t, res);
+}
+
+void
+gxr_rigid_pose_init_identity (GxrRigidPose *self)
+{
+  graphene_quaternion_init_identity (&self->orientation);
+  graphene_vec3_init_from_vec3 (&self->position, graphene_vec3_zero ());
+}
+
+void
+gxr_rigid_pose_init (GxrRigidPose                *self,
+                     const graphene_quaternion_t *orientation,
+                     const graphene_vec3_t       *position)
+{
+  graphene_quaternion_init_from_quaternion (&self->orientation, orientation);
+  graphene_vec3_init_from_vec3 (&self->position, position);
+}
+
+void
+gxr_rigid_pose_init_from_xr (GxrRigidPose *self, const XrPosef *pose)
+{
+  graphene_quaternion_init (&self->orientation, pose->orientation.x,
+                            pose->orientation.y, pose->orientation.z,
+                            pose->orientation.w);
+  graphene_vec3_init (&self->position, pose->position.x, pose->position.y,
+                      pose->position.z);
+}
+
+/*
+ * Transforms by a first and b second, like graphene_matrix_multiply() does
+ * with the matrices of a and b.
+ */
+void
+gxr_rigid_pose_multiply (const GxrRigidPose *a,
+                         const GxrRigidPose *b,
+                         GxrRigidPose       *res)
+{
+  GxrRigidPose r;
+  _quaternion_multiply (&b->orientation, &a->orientation, &r.orientation);
+  _rotate_vec3 (&b->orientation, &a->position, &r.position);
+  graphene_vec3_add (&r.position, &b->position, &r.position);
+  *res = r;
+}
+
+/* The rotation is transposed, so no general matrix inverse is needed. */
+void
+gxr_rigid_pose_inverse (const GxrRigidPose *self, GxrRigidPose *res)
+{
+  graphene_vec4_t q;
+  graphene_quaternion_to_vec4 (&self->orientation, &q);
+
+  GxrRigidPose r;
+  graphene_quaternion_init (&r.orientation, -graphene_vec4_get_x (&q),
+                            -graphene_vec4_get_y (&q),
+                            -graphene_vec4_get_z (&q),
+                            graphene_vec4_get_w (&q));
+  _rotate_vec3 (&r.orientation, &self->position, &r.position);
+  graphene_vec3_negate (&r.position, &r.position);
+  *res = r;
+}
+
+void
+gxr_rigid_pose_transform_point (const GxrRigidPose       *self,
+                                const graphene_point3d_t *p,
+                                graphene_point3d_t       *res)
+{
+  graphene_vec3_t v;
+  graphene_point3d_to_vec3 (p, &v);
+  _rotate_vec3 (&self->orientation, &v, &v);
+  graphene_vec3_add (&v, &self->position, &v);
+  graphene_point3d_init_from_vec3 (res, &v);
+}
+
+void
+gxr_rigid_pose_to_matrix (const GxrRigidPose *self, graphene_matrix_t *mat)
+{
+  graphene_point3d_t translation;
+  graphene_point3d_init_from_vec3 (&translation, &self->position);
+
+  graphene_matrix_init_identity (mat);
+  graphene_matrix_rotate_quaternion (mat, &self->orientation);
+  graphene_matrix_translate (mat, &translation);
+}
@@ -0,0 +1,65 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_RIGID_POSE_H_
+#define GXR_RIGID_POSE_H_
+
+#if !defined(GXR_INSIDE) && !defined(GXR_COMPILATION)
+#error "Only <gxr.h> can be included directly."
+#endif
+
+#include <glib.h>
+#include <graphene.h>
+#include <openxr/openxr.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GxrRigidPose:
+ * @orientation: The rotation, applied first.
+ * @position: The translation, applied after the rotation.
+ *
+ * A transformation without scale or shear. Half the size of a
+ * #graphene_matrix_t, and inverted by conjugating the rotation instead of
+ * a general matrix inverse. Convert it with gxr_rigid_pose_to_matrix()
+ * where a matrix is needed.
+ **/
+typedef struct
+{
+  graphene_quaternion_t orientation;
+  graphene_vec3_t       position;
+} GxrRigidPose;
+
+void
+gxr_rigid_pose_init_identity (GxrRigidPose *self);
+
+void
+gxr_rigid_pose_init (GxrRigidPose                *self,
+                     const graphene_quaternion_t *orientation,
+                     const graphene_vec3_t       *position);
+
+void
+gxr_rigid_pose_init_from_xr (GxrRigidPose *self, const XrPosef *pose);
+
+void
+gxr_rigid_pose_multiply (const GxrRigidPose *a,
+                         const GxrRigidPose *b,
+                         GxrRigidPose       *res);
+
+void
+gxr_rigid_pose_inverse (const GxrRigidPose *self, GxrRigidPose *res);
+
+void
+gxr_rigid_pose_transform_point (const GxrRigidPose       *self,
+                                const graphene_point3d_t *p,
+                                graphene_point3d_t       *res);
+
+void
+gxr_rigid_pose_to_matrix (const GxrRigidPose *self, graphene_matrix_t *mat);
+
+G_END_DECLS
+
+#endif /* GXR_RIGID_POSE_H_ */
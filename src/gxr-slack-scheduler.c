@@ -0,0 +1,118 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-slack-scheduler.h"
+
+typedef struct
+{
+  GxrSlackTaskFunc func;
+  gpointer         data;
+  GDestroyNotify   destroy;
+  /* moving average of the measured durations in microseconds */
+  int64_t estimate;
+  /* runs in a row in which the estimate did not fit */
+  uint32_t skips;
+} GxrSlackTask;
+
+struct _GxrSlackScheduler
+{
+  GQueue tasks;
+};
+
+GxrSlackScheduler *
+gxr_slack_scheduler_new (void)
+{
+  GxrSlackScheduler *self = g_new (GxrSlackScheduler, 1);
+  g_queue_init (&self->tasks);
+  return self;
+}
+
+static void
+_task_free (gpointer data)
+{
+  GxrSlackTask *task = data;
+  if (task->destroy)
+    task->destroy (task->data);
+  g_free (task);
+}
+
+void
+gxr_slack_scheduler_free (GxrSlackScheduler *self)
+{
+  g_queue_clear_full (&self->tasks, _task_free);
+  g_free (self);
+}
+
+void
+gxr_slack_scheduler_add (GxrSlackScheduler *self,
+                         GxrSlackTaskFunc   func,
+                         gpointer           data,
+                         GDestroyNotify     destroy)
+{
+  GxrSlackTask *task = g_new (GxrSlackTask, 1);
+  task->func = func;
+  task->data = data;
+  task->destroy = destroy;
+  task->estimate = GXR_SLACK_TASK_DEFAULT_ESTIMATE;
+  task->skips = 0;
+  g_queue_push_tail (&self->tasks, task);
+}
+
+/*
+ * Runs the queued tasks in order as long as their estimated duration fits
+ * before deadline (monotonic, microseconds). Tasks that do not fit stay
+ * queued for the next run, as do tasks that return TRUE. A task that did not
+ * fit for GXR_SLACK_TASK_MAX_SKIPS runs runs anyway, so tasks longer than any
+ * slack do not starve.
+ * Returns the number of tasks that ran.
+ */
+uint32_t
+gxr_slack_scheduler_run (GxrSlackScheduler *self, int64_t deadline)
+{
+  uint32_t ran = 0;
+
+  GList *l = self->tasks.head;
+  while (l)
+    {
+      GList        *next = l->next;
+      GxrSlackTask *task = l->data;
+
+      int64_t start = g_get_monotonic_time ();
+      if (start >= deadline)
+        break;
+
+      if (start + task->estimate > deadline
+          && task->skips < GXR_SLACK_TASK_MAX_SKIPS)
+        {
+          task->skips++;
+          l = next;
+          continue;
+        }
+
+      task->skips = 0;
+      gboolean again = task->func (task->data);
+      ran++;
+
+      int64_t duration = g_get_monotonic_time () - start;
+      task->estimate = (task->estimate + 3 * duration) / 4;
+
+      if (!again)
+        {
+          g_queue_delete_link (&self->tasks, l);
+          _task_free (task);
+        }
+
+      l = next;
+    }
+
+  return ran;
+}
+
+uint32_t
+gxr_slack_scheduler_get_pending (GxrSlackScheduler *self)
+{
+  return self->tasks.length;
+}
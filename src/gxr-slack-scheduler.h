@@ -0,0 +1,41 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_SLACK_SCHEDULER_H_
+#define GXR_SLACK_SCHEDULER_H_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "gxr-context.h"
+
+/* Assumed duration of a task that did not run yet, in microseconds */
+#define GXR_SLACK_TASK_DEFAULT_ESTIMATE 500
+
+/* Runs after which a task that never fit runs anyway */
+#define GXR_SLACK_TASK_MAX_SKIPS 30
+
+typedef struct _GxrSlackScheduler GxrSlackScheduler;
+
+GxrSlackScheduler *
+gxr_slack_scheduler_new (void);
+
+void
+gxr_slack_scheduler_free (GxrSlackScheduler *self);
+
+void
+gxr_slack_scheduler_add (GxrSlackScheduler *self,
+                         GxrSlackTaskFunc   func,
+                         gpointer           data,
+                         GDestroyNotify     destroy);
+
+uint32_t
+gxr_slack_scheduler_run (GxrSlackScheduler *self, int64_t deadline);
+
+uint32_t
+gxr_slack_scheduler_get_pending (GxrSlackScheduler *self);
+
+#endif /* GXR_SLACK_SCHEDULER_H_ */
@@ -0,0 +1,116 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-space-cache.h"
+
+typedef struct
+{
+  XrSpace          space;
+  XrSpace          base_space;
+  GxrSpaceRelation relation;
+} GxrSpaceCacheEntry;
+
+void
+gxr_space_cache_init (GxrSpaceCache *self)
+{
+  self->entries = g_array_new (FALSE, FALSE, sizeof (GxrSpaceCacheEntry));
+  self->time = 0;
+  self->hits = 0;
+  self->misses = 0;
+}
+
+void
+gxr_space_cache_clear (GxrSpaceCache *self)
+{
+  g_clear_pointer (&self->entries, g_array_unref);
+}
+
+/* Drops the entries when time differs from the one they were located at. */
+void
+gxr_space_cache_set_time (GxrSpaceCache *self, XrTime time)
+{
+  if (self->time == time)
+    return;
+
+  g_array_set_size (self->entries, 0);
+  self->time = time;
+}
+
+static GxrSpaceCacheEntry *
+_find (GxrSpaceCache *self, XrSpace space, XrSpace base_space)
+{
+  /* a frame only has a few relations, a linear scan beats hashing */
+  for (uint32_t i = 0; i < self->entries->len; i++)
+    {
+      GxrSpaceCacheEntry *entry = &g_array_index (self->entries,
+                                                  GxrSpaceCacheEntry, i);
+      if (entry->space == space && entry->base_space == base_space)
+        return entry;
+    }
+  return NULL;
+}
+
+/* Relations at other times than the one of the frame are always a miss. */
+gboolean
+gxr_space_cache_lookup (GxrSpaceCache    *self,
+                        XrSpace           space,
+                        XrSpace           base_space,
+                        XrTime            time,
+                        GxrSpaceRelation *relation)
+{
+  GxrSpaceCacheEntry *entry = time == self->time
+                                ? _find (self, space, base_space)
+                                : NULL;
+  if (!entry)
+    {
+      self->misses++;
+      return FALSE;
+    }
+
+  self->hits++;
+  *relation = entry->relation;
+  return TRUE;
+}
+
+/* Like gxr_space_cache_lookup, but without counting. */
+gboolean
+gxr_space_cache_peek (GxrSpaceCache    *self,
+                      XrSpace           space,
+                      XrSpace           base_space,
+                      GxrSpaceRelation *relation)
+{
+  GxrSpaceCacheEntry *entry = _find (self, space, base_space);
+  if (!entry)
+    return FALSE;
+
+  *relation = entry->relation;
+  return TRUE;
+}
+
+void
+gxr_space_cache_insert (GxrSpaceCache          *self,
+                        XrSpace                 space,
+                        XrSpace                 base_space,
+                        XrTime                  time,
+                        const GxrSpaceRelation *relation)
+{
+  if (time != self->time)
+    return;
+
+  GxrSpaceCacheEntry *entry = _find (self, space, base_space);
+  if (entry)
+    {
+      entry->relation = *relation;
+      return;
+    }
+
+  GxrSpaceCacheEntry new_entry = {
+    .space = space,
+    .base_space = base_space,
+    .relation = *relation,
+  };
+  g_array_append_val (self->entries, new_entry);
+}
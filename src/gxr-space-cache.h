@@ -0,0 +1,57 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_SPACE_CACHE_H_
+#define GXR_SPACE_CACHE_H_
+
+#include <glib.h>
+#include <openxr/openxr.h>
+#include <stdint.h>
+
+#include "gxr-space-locator.h"
+
+/*
+ * Space relations located at the display time of the frame, keyed on space
+ * and base space. The entries are dropped when the time advances.
+ */
+typedef struct
+{
+  GArray  *entries;
+  XrTime   time;
+  uint64_t hits;
+  uint64_t misses;
+} GxrSpaceCache;
+
+void
+gxr_space_cache_init (GxrSpaceCache *self);
+
+void
+gxr_space_cache_clear (GxrSpaceCache *self);
+
+void
+gxr_space_cache_set_time (GxrSpaceCache *self, XrTime time);
+
+gboolean
+gxr_space_cache_lookup (GxrSpaceCache    *self,
+                        XrSpace           space,
+                        XrSpace           base_space,
+                        XrTime            time,
+                        GxrSpaceRelation *relation);
+
+gboolean
+gxr_space_cache_peek (GxrSpaceCache    *self,
+                      XrSpace           space,
+                      XrSpace           base_space,
+                      GxrSpaceRelation *relation);
+
+void
+gxr_space_cache_insert (GxrSpaceCache          *self,
+                        XrSpace                 space,
+                        XrSpace                 base_space,
+                        XrTime                  time,
+                        const GxrSpaceRelation *relation);
+
+#endif /* GXR_SPACE_CACHE_H_ */
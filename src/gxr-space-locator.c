@@ -0,0 +1,347 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-space-locator.h"
+
+#include <math.h>
+
+/* bounds of tracked motion for the error of extrapolated poses */
+#define PREDICTION_MAX_SPEED 5.0f
+#define PREDICTION_MAX_ACCELERATION 30.0f
+
+struct _GxrSpaceLocator
+{
+  XrInstance instance;
+  XrSession  session;
+
+  /* NULL when neither OpenXR 1.1 nor XR_KHR_locate_spaces is available */
+  PFN_xrLocateSpacesKHR locate_spaces;
+
+  /* XrSpace, XrSpaceLocationDataKHR and XrSpaceVelocityDataKHR, packed so
+   * one call fills all */
+  GArray *spaces;
+  GArray *locations;
+  GArray *velocities;
+  /* uint32_t slot of each packed index, and index of each slot */
+  GArray *index_slots;
+  GArray *slot_indices;
+};
+
+static void
+_printerr_xr_result (XrInstance instance, XrResult result)
+{
+  char buffer[XR_MAX_RESULT_STRING_SIZE];
+  xrResultToString (instance, result, buffer);
+  g_printerr ("%s\n", buffer);
+}
+
+static PFN_xrLocateSpacesKHR
+_load_locate_spaces (XrInstance instance, gboolean locate_spaces_ext)
+{
+  PFN_xrLocateSpacesKHR locate_spaces = NULL;
+  const char           *name = locate_spaces_ext ? "xrLocateSpacesKHR" : NULL;
+
+#ifdef XR_VERSION_1_1
+  /* core in 1.1, but unsupported on 1.0 instances */
+  if (!name)
+    name = "xrLocateSpaces";
+#endif
+
+  /* without an instance, spaces can only be registered */
+  if (!name || instance == XR_NULL_HANDLE)
+    return NULL;
+
+  XrResult result = xrGetInstanceProcAddr (instance, name,
+                                           (PFN_xrVoidFunction *)
+                                             &locate_spaces);
+  if (result != XR_SUCCESS)
+    return NULL;
+
+  return locate_spaces;
+}
+
+GxrSpaceLocator *
+gxr_space_locator_new (XrInstance instance,
+                       XrSession  session,
+                       gboolean   locate_spaces_ext)
+{
+  GxrSpaceLocator *self = g_new0 (GxrSpaceLocator, 1);
+  self->instance = instance;
+  self->session = session;
+  self->locate_spaces = _load_locate_spaces (instance, locate_spaces_ext);
+
+  self->spaces = g_array_new (FALSE, FALSE, sizeof (XrSpace));
+  self->locations = g_array_new (FALSE, TRUE, sizeof (XrSpaceLocationDataKHR));
+  self->velocities = g_array_new (FALSE, TRUE, sizeof (XrSpaceVelocityDataKHR));
+  self->index_slots = g_array_new (FALSE, FALSE, sizeof (uint32_t));
+  self->slot_indices = g_array_new (FALSE, FALSE, sizeof (uint32_t));
+
+  g_debug ("Locating spaces %s",
+           self->locate_spaces ? "in one call" : "one by one");
+
+  return self;
+}
+
+void
+gxr_space_locator_free (GxrSpaceLocator *self)
+{
+  g_array_unref (self->spaces);
+  g_array_unref (self->locations);
+  g_array_unref (self->velocities);
+  g_array_unref (self->index_slots);
+  g_array_unref (self->slot_indices);
+  g_free (self);
+}
+
+/* Returns a slot that stays valid until the space is removed. */
+uint32_t
+gxr_space_locator_add (GxrSpaceLocator *self, XrSpace space)
+{
+  uint32_t slot = 0;
+  while (slot < self->slot_indices->len
+         && g_array_index (self->slot_indices, uint32_t, slot)
+              != GXR_SPACE_LOCATOR_INVALID_SLOT)
+    slot++;
+
+  uint32_t index = self->spaces->len;
+  if (slot == self->slot_indices->len)
+    g_array_append_val (self->slot_indices, index);
+  else
+    g_array_index (self->slot_indices, uint32_t, slot) = index;
+
+  XrSpaceLocationDataKHR location = {0};
+  XrSpaceVelocityDataKHR velocity = {0};
+  g_array_append_val (self->spaces, space);
+  g_array_append_val (self->locations, location);
+  g_array_append_val (self->velocities, velocity);
+  g_array_append_val (self->index_slots, slot);
+
+  return slot;
+}
+
+/* Moves the last space into the gap, so the arrays stay packed. */
+void
+gxr_space_locator_remove (GxrSpaceLocator *self, uint32_t slot)
+{
+  if (slot >= self->slot_indices->len)
+    return;
+
+  uint32_t index = g_array_index (self->slot_indices, uint32_t, slot);
+  if (index == GXR_SPACE_LOCATOR_INVALID_SLOT)
+    return;
+
+  uint32_t last = self->spaces->len - 1;
+  uint32_t last_slot = g_array_index (self->index_slots, uint32_t, last);
+
+  g_array_remove_index_fast (self->spaces, index);
+  g_array_remove_index_fast (self->locations, index);
+  g_array_remove_index_fast (self->velocities, index);
+  g_array_remove_index_fast (self->index_slots, index);
+
+  if (index != last)
+    g_array_index (self->slot_indices, uint32_t, last_slot) = index;
+  g_array_index (self->slot_indices, uint32_t, slot)
+    = GXR_SPACE_LOCATOR_INVALID_SLOT;
+}
+
+static gboolean
+_locate_batched (GxrSpaceLocator *self, XrSpace base_space, XrTime time)
+{
+  XrSpacesLocateInfoKHR info = {
+    .type = XR_TYPE_SPACES_LOCATE_INFO_KHR,
+    .baseSpace = base_space,
+    .time = time,
+    .spaceCount = self->spaces->len,
+    .spaces = (XrSpace *) self->spaces->data,
+  };
+  XrSpaceVelocitiesKHR velocities = {
+    .type = XR_TYPE_SPACE_VELOCITIES_KHR,
+    .velocityCount = self->velocities->len,
+    .velocities = (XrSpaceVelocityDataKHR *) self->velocities->data,
+  };
+  XrSpaceLocationsKHR locations = {
+    .type = XR_TYPE_SPACE_LOCATIONS_KHR,
+    .next = &velocities,
+    .locationCount = self->locations->len,
+    .locations = (XrSpaceLocationDataKHR *) self->locations->data,
+  };
+
+  XrResult result = self->locate_spaces (self->session, &info, &locations);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to locate spaces: ");
+      _printerr_xr_result (self->instance, result);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+_locate_each (GxrSpaceLocator *self, XrSpace base_space, XrTime time)
+{
+  gboolean success = TRUE;
+  for (uint32_t i = 0; i < self->spaces->len; i++)
+    {
+      GxrSpaceRelation relation;
+      XrSpace          space = g_array_index (self->spaces, XrSpace, i);
+      if (!gxr_space_locator_locate_one (self, space, base_space, time,
+                                         &relation))
+        success = FALSE;
+
+      g_array_index (self->locations, XrSpaceLocationDataKHR, i)
+        = relation.location;
+      g_array_index (self->velocities, XrSpaceVelocityDataKHR, i)
+        = relation.velocity;
+    }
+
+  return success;
+}
+
+/* Locates all spaces at time. */
+gboolean
+gxr_space_locator_update (GxrSpaceLocator *self,
+                          XrSpace          base_space,
+                          XrTime           time)
+{
+  if (self->spaces->len == 0)
+    return TRUE;
+
+  return self->locate_spaces ? _locate_batched (self, base_space, time)
+                             : _locate_each (self, base_space, time);
+}
+
+XrSpace
+gxr_space_locator_get_space (GxrSpaceLocator *self, uint32_t slot)
+{
+  if (slot >= self->slot_indices->len)
+    return XR_NULL_HANDLE;
+
+  uint32_t index = g_array_index (self->slot_indices, uint32_t, slot);
+  if (index == GXR_SPACE_LOCATOR_INVALID_SLOT)
+    return XR_NULL_HANDLE;
+
+  return g_array_index (self->spaces, XrSpace, index);
+}
+
+gboolean
+gxr_space_locator_contains (GxrSpaceLocator *self, XrSpace space)
+{
+  for (uint32_t i = 0; i < self->spaces->len; i++)
+    if (g_array_index (self->spaces, XrSpace, i) == space)
+      return TRUE;
+  return FALSE;
+}
+
+/* The packed spaces of the last update. */
+uint32_t
+gxr_space_locator_get_located (GxrSpaceLocator               *self,
+                               const XrSpace                **spaces,
+                               const XrSpaceLocationDataKHR **locations,
+                               const XrSpaceVelocityDataKHR **velocities)
+{
+  *spaces = (const XrSpace *) self->spaces->data;
+  *locations = (const XrSpaceLocationDataKHR *) self->locations->data;
+  *velocities = (const XrSpaceVelocityDataKHR *) self->velocities->data;
+  return self->spaces->len;
+}
+
+/* Locates a space that does not need to be registered, at any time. */
+gboolean
+gxr_space_locator_locate_one (GxrSpaceLocator  *self,
+                              XrSpace           space,
+                              XrSpace           base_space,
+                              XrTime            time,
+                              GxrSpaceRelation *relation)
+{
+  XrSpaceVelocity velocity = {
+    .type = XR_TYPE_SPACE_VELOCITY,
+  };
+  XrSpaceLocation location = {
+    .type = XR_TYPE_SPACE_LOCATION,
+    .next = &velocity,
+  };
+
+  XrResult result = xrLocateSpace (space, base_space, time, &location);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to locate space: ");
+      _printerr_xr_result (self->instance, result);
+      *relation = (GxrSpaceRelation){0};
+      return FALSE;
+    }
+
+  relation->location.locationFlags = location.locationFlags;
+  relation->location.pose = location.pose;
+  relation->velocity.velocityFlags = velocity.velocityFlags;
+  relation->velocity.linearVelocity = velocity.linearVelocity;
+  relation->velocity.angularVelocity = velocity.angularVelocity;
+
+  return TRUE;
+}
+
+gboolean
+gxr_space_locator_is_batched (GxrSpaceLocator *self)
+{
+  return self->locate_spaces != NULL;
+}
+
+static void
+_quaternion_multiply (const XrQuaternionf *a,
+                      const XrQuaternionf *b,
+                      XrQuaternionf       *res)
+{
+  XrQuaternionf r = {
+    .x = a->w * b->x + a->x * b->w + a->y * b->z - a->z * b->y,
+    .y = a->w * b->y - a->x * b->z + a->y * b->w + a->z * b->x,
+    .z = a->w * b->z + a->x * b->y - a->y * b->x + a->z * b->w,
+    .w = a->w * b->w - a->x * b->x - a->y * b->y - a->z * b->z,
+  };
+  *res = r;
+}
+
+/*
+ * Integrates the velocities of the relation over dt seconds and returns the
+ * error bound of the position in meters. The angular velocity is in the base
+ * space, so its rotation is applied on the left.
+ */
+float
+gxr_space_relation_extrapolate (GxrSpaceRelation *relation, float dt)
+{
+  XrSpaceVelocityDataKHR *v = &relation->velocity;
+  XrPosef                *pose = &relation->location.pose;
+
+  float error = PREDICTION_MAX_SPEED * fabsf (dt);
+
+  if (v->velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT)
+    {
+      pose->position.x += v->linearVelocity.x * dt;
+      pose->position.y += v->linearVelocity.y * dt;
+      pose->position.z += v->linearVelocity.z * dt;
+      error = 0.5f * PREDICTION_MAX_ACCELERATION * dt * dt;
+    }
+
+  if (v->velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT)
+    {
+      XrVector3f *w = &v->angularVelocity;
+      float       speed = sqrtf (w->x * w->x + w->y * w->y + w->z * w->z);
+      if (speed > 0.0f)
+        {
+          float         half_angle = 0.5f * speed * dt;
+          float         s = sinf (half_angle) / speed;
+          XrQuaternionf delta = {
+            .x = w->x * s,
+            .y = w->y * s,
+            .z = w->z * s,
+            .w = cosf (half_angle),
+          };
+          _quaternion_multiply (&delta, &pose->orientation,
+                                &pose->orientation);
+        }
+    }
+
+  return error;
+}
@@ -0,0 +1,74 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_SPACE_LOCATOR_H_
+#define GXR_SPACE_LOCATOR_H_
+
+#include <glib.h>
+#include <openxr/openxr.h>
+#include <stdint.h>
+
+/* Slot of a space that is not registered */
+#define GXR_SPACE_LOCATOR_INVALID_SLOT G_MAXUINT32
+
+/* Pose and velocity of a space relative to a base space */
+typedef struct
+{
+  XrSpaceLocationDataKHR location;
+  XrSpaceVelocityDataKHR velocity;
+} GxrSpaceRelation;
+
+/*
+ * Locates all registered spaces relative to one base space with a single
+ * xrLocateSpaces call, or one xrLocateSpace call per space as fallback.
+ */
+typedef struct _GxrSpaceLocator GxrSpaceLocator;
+
+GxrSpaceLocator *
+gxr_space_locator_new (XrInstance instance,
+                       XrSession  session,
+                       gboolean   locate_spaces_ext);
+
+void
+gxr_space_locator_free (GxrSpaceLocator *self);
+
+uint32_t
+gxr_space_locator_add (GxrSpaceLocator *self, XrSpace space);
+
+void
+gxr_space_locator_remove (GxrSpaceLocator *self, uint32_t slot);
+
+gboolean
+gxr_space_locator_update (GxrSpaceLocator *self,
+                          XrSpace          base_space,
+                          XrTime           time);
+
+XrSpace
+gxr_space_locator_get_space (GxrSpaceLocator *self, uint32_t slot);
+
+gboolean
+gxr_space_locator_contains (GxrSpaceLocator *self, XrSpace space);
+
+uint32_t
+gxr_space_locator_get_located (GxrSpaceLocator               *self,
+                               const XrSpace                **spaces,
+                               const XrSpaceLocationDataKHR **locations,
+                               const XrSpaceVelocityDataKHR **velocities);
+
+gboolean
+gxr_space_locator_locate_one (GxrSpaceLocator  *self,
+                              XrSpace           space,
+                              XrSpace           base_space,
+                              XrTime            time,
+                              GxrSpaceRelation *relation);
+
+gboolean
+gxr_space_locator_is_batched (GxrSpaceLocator *self);
+
+float
+gxr_space_relation_extrapolate (GxrSpaceRelation *relation, float dt);
+
+#endif /* GXR_SPACE_LOCATOR_H_ */
@@ -0,0 +1,52 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-staging-ring.h"
+
+void
+gxr_staging_ring_init (GxrStagingRing *self, VkDeviceSize size)
+{
+  self->size = size;
+  self->head = 0;
+}
+
+static VkDeviceSize
+_align (VkDeviceSize offset, VkDeviceSize alignment)
+{
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+/*
+ * Finds size contiguous bytes at alignment after head, wrapping around to
+ * the start of the ring. tail is the start of the oldest pending range, or
+ * NULL if no range is pending.
+ */
+GxrStagingRingResult
+gxr_staging_ring_reserve (GxrStagingRing     *self,
+                          VkDeviceSize        size,
+                          VkDeviceSize        alignment,
+                          const VkDeviceSize *tail,
+                          VkDeviceSize       *offset)
+{
+  if (size > self->size)
+    return GXR_STAGING_RING_TOO_LARGE;
+
+  VkDeviceSize head = _align (self->head, alignment);
+
+  if (!tail)
+    *offset = 0;
+  else if (self->head > *tail && head + size <= self->size)
+    *offset = head;
+  else if (self->head > *tail && size <= *tail)
+    *offset = 0;
+  else if (self->head < *tail && head + size <= *tail)
+    *offset = head;
+  else
+    return GXR_STAGING_RING_FULL;
+
+  self->head = *offset + size;
+  return GXR_STAGING_RING_RESERVED;
+}
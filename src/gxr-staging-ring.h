@@ -0,0 +1,43 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_STAGING_RING_H_
+#define GXR_STAGING_RING_H_
+
+#include <glib.h>
+#include <vulkan/vulkan.h>
+
+typedef enum
+{
+  GXR_STAGING_RING_RESERVED,
+  /* fits once the oldest pending range is free */
+  GXR_STAGING_RING_FULL,
+  /* larger than the whole ring, never fits */
+  GXR_STAGING_RING_TOO_LARGE,
+} GxrStagingRingResult;
+
+/*
+ * Byte ranges of a staging buffer handed out in order. The pending ranges
+ * are contiguous from the start of the oldest one to head.
+ */
+typedef struct
+{
+  VkDeviceSize size;
+  /* next free byte */
+  VkDeviceSize head;
+} GxrStagingRing;
+
+void
+gxr_staging_ring_init (GxrStagingRing *self, VkDeviceSize size);
+
+GxrStagingRingResult
+gxr_staging_ring_reserve (GxrStagingRing     *self,
+                          VkDeviceSize        size,
+                          VkDeviceSize        alignment,
+                          const VkDeviceSize *tail,
+                          VkDeviceSize       *offset);
+
+#endif /* GXR_STAGING_RING_H_ */
@@ -0,0 +1,653 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-texture-uploader.h"
+
+#include <string.h>
+
+#include "gxr-staging-ring.h"
+
+/* uploads in flight, each with its own command buffer and semaphore */
+#define UPLOAD_SUBMISSION_COUNT 8
+
+struct GxrUploadSubmission
+{
+  VkCommandBuffer cmd_buffer;
+  VkFence         fence;
+  VkSemaphore     semaphore;
+  /* staging range read by the submission */
+  VkDeviceSize offset;
+  VkDeviceSize size;
+  gboolean     pending;
+};
+
+struct _GxrTextureUploader
+{
+  GObject parent;
+
+  GxrContext  *context;
+  VkDevice     device;
+  GulkanQueue *queue;
+  uint32_t     transfer_family;
+  uint32_t     graphics_family;
+
+  VkCommandPool pool;
+
+  /* persistently mapped, used as a ring */
+  VkBuffer       staging_buffer;
+  VkDeviceMemory staging_memory;
+  uint8_t       *staging_map;
+  GxrStagingRing staging_ring;
+
+  /* used round robin, so the next one is the oldest if it is pending */
+  struct GxrUploadSubmission submissions[UPLOAD_SUBMISSION_COUNT];
+  uint32_t                   next_submission;
+};
+
+G_DEFINE_TYPE (GxrTextureUploader, gxr_texture_uploader, G_TYPE_OBJECT)
+
+static void
+gxr_texture_uploader_finalize (GObject *gobject);
+
+static void
+gxr_texture_uploader_class_init (GxrTextureUploaderClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  object_class->finalize = gxr_texture_uploader_finalize;
+}
+
+static void
+gxr_texture_uploader_init (GxrTextureUploader *self)
+{
+  self->context = NULL;
+  self->device = VK_NULL_HANDLE;
+  self->queue = NULL;
+  self->pool = VK_NULL_HANDLE;
+  self->staging_buffer = VK_NULL_HANDLE;
+  self->staging_memory = VK_NULL_HANDLE;
+  self->staging_map = NULL;
+  gxr_staging_ring_init (&self->staging_ring, 0);
+  memset (self->submissions, 0, sizeof (self->submissions));
+  self->next_submission = 0;
+}
+
+static gboolean
+_find_memory_type (VkPhysicalDevice      physical_device,
+                   uint32_t              type_bits,
+                   VkMemoryPropertyFlags properties,
+                   uint32_t             *index)
+{
+  VkPhysicalDeviceMemoryProperties memory_properties;
+  vkGetPhysicalDeviceMemoryProperties (physical_device, &memory_properties);
+
+  for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+    {
+      if ((type_bits & (1u << i))
+          && (memory_properties.memoryTypes[i].propertyFlags & properties)
+               == properties)
+        {
+          *index = i;
+          return TRUE;
+        }
+    }
+  return FALSE;
+}
+
+static gboolean
+_init_staging (GxrTextureUploader *self, VkDeviceSize size)
+{
+  GulkanDevice *gulkan_device = gulkan_context_get_device (
+    gxr_context_get_gulkan (self->context));
+
+  VkBufferCreateInfo buffer_info = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    .size = size,
+    .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+  };
+  VkResult res = vkCreateBuffer (self->device, &buffer_info, NULL,
+                                 &self->staging_buffer);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not create staging buffer: %d\n", res);
+      return FALSE;
+    }
+
+  VkMemoryRequirements requirements;
+  vkGetBufferMemoryRequirements (self->device, self->staging_buffer,
+                                 &requirements);
+
+  /* coherent, so the ring never needs to be flushed */
+  VkMemoryAllocateInfo alloc_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+    .allocationSize = requirements.size,
+  };
+  if (!_find_memory_type (gulkan_device_get_physical_handle (gulkan_device),
+                          requirements.memoryTypeBits,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          &alloc_info.memoryTypeIndex))
+    {
+      g_printerr ("No host coherent memory for the staging buffer.\n");
+      return FALSE;
+    }
+
+  res = vkAllocateMemory (self->device, &alloc_info, NULL,
+                          &self->staging_memory);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not allocate staging memory: %d\n", res);
+      return FALSE;
+    }
+
+  vkBindBufferMemory (self->device, self->staging_buffer, self->staging_memory,
+                      0);
+
+  res = vkMapMemory (self->device, self->staging_memory, 0, VK_WHOLE_SIZE, 0,
+                     (void **) &self->staging_map);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not map staging memory: %d\n", res);
+      return FALSE;
+    }
+
+  gxr_staging_ring_init (&self->staging_ring, size);
+
+  return TRUE;
+}
+
+static gboolean
+_init_submissions (GxrTextureUploader *self)
+{
+  VkCommandPoolCreateInfo pool_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+    .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+    .queueFamilyIndex = self->transfer_family,
+  };
+  VkResult res = vkCreateCommandPool (self->device, &pool_info, NULL,
+                                      &self->pool);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not create upload command pool: %d\n", res);
+      return FALSE;
+    }
+
+  for (uint32_t i = 0; i < UPLOAD_SUBMISSION_COUNT; i++)
+    {
+      struct GxrUploadSubmission *submission = &self->submissions[i];
+
+      VkCommandBufferAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = self->pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+      };
+      res = vkAllocateCommandBuffers (self->device, &alloc_info,
+                                      &submission->cmd_buffer);
+      if (res != VK_SUCCESS)
+        {
+          g_printerr ("Could not allocate upload command buffer: %d\n", res);
+          return FALSE;
+        }
+
+      VkFenceCreateInfo fence_info = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+      };
+      res = vkCreateFence (self->device, &fence_info, NULL,
+                           &submission->fence);
+      if (res != VK_SUCCESS)
+        {
+          g_printerr ("Could not create upload fence: %d\n", res);
+          return FALSE;
+        }
+
+      VkSemaphoreCreateInfo semaphore_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+      };
+      res = vkCreateSemaphore (self->device, &semaphore_info, NULL,
+                               &submission->semaphore);
+      if (res != VK_SUCCESS)
+        {
+          g_printerr ("Could not create upload semaphore: %d\n", res);
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+/*
+ * Creates an uploader that copies to images on the transfer queue of the
+ * context, through a staging ring of staging_size bytes. A single upload
+ * needs to fit into the ring.
+ */
+GxrTextureUploader *
+gxr_texture_uploader_new (GxrContext *context, VkDeviceSize staging_size)
+{
+  GxrTextureUploader *self = (GxrTextureUploader *)
+    g_object_new (GXR_TYPE_TEXTURE_UPLOADER, 0);
+
+  GulkanDevice *gulkan_device = gulkan_context_get_device (
+    gxr_context_get_gulkan (context));
+
+  self->context = g_object_ref (context);
+  self->device = gulkan_device_get_handle (gulkan_device);
+  self->queue = gulkan_device_get_transfer_queue (gulkan_device);
+  self->transfer_family = gulkan_queue_get_family_index (self->queue);
+  self->graphics_family = gulkan_queue_get_family_index (
+    gulkan_device_get_graphics_queue (gulkan_device));
+
+  if (!_init_staging (self, staging_size) || !_init_submissions (self))
+    {
+      g_object_unref (self);
+      return NULL;
+    }
+
+  g_debug ("Created texture uploader with %" G_GUINT64_FORMAT " byte staging "
+           "ring, transfer family %d, graphics family %d",
+           (guint64) self->staging_ring.size, self->transfer_family,
+           self->graphics_family);
+
+  return self;
+}
+
+static void
+_wait_submission (GxrTextureUploader         *self,
+                  struct GxrUploadSubmission *submission)
+{
+  if (!submission->pending)
+    return;
+
+  vkWaitForFences (self->device, 1, &submission->fence, VK_TRUE, UINT64_MAX);
+  submission->pending = FALSE;
+}
+
+void
+gxr_texture_uploader_wait_idle (GxrTextureUploader *self)
+{
+  for (uint32_t i = 0; i < UPLOAD_SUBMISSION_COUNT; i++)
+    _wait_submission (self, &self->submissions[i]);
+}
+
+static void
+gxr_texture_uploader_finalize (GObject *gobject)
+{
+  GxrTextureUploader *self = GXR_TEXTURE_UPLOADER (gobject);
+
+  if (self->device != VK_NULL_HANDLE)
+    {
+      gxr_texture_uploader_wait_idle (self);
+
+      for (uint32_t i = 0; i < UPLOAD_SUBMISSION_COUNT; i++)
+        {
+          struct GxrUploadSubmission *submission = &self->submissions[i];
+          if (submission->fence != VK_NULL_HANDLE)
+            vkDestroyFence (self->device, submission->fence, NULL);
+          if (submission->semaphore != VK_NULL_HANDLE)
+            vkDestroySemaphore (self->device, submission->semaphore, NULL);
+        }
+
+      if (self->pool != VK_NULL_HANDLE)
+        vkDestroyCommandPool (self->device, self->pool, NULL);
+
+      if (self->staging_map)
+        vkUnmapMemory (self->device, self->staging_memory);
+      if (self->staging_buffer != VK_NULL_HANDLE)
+        vkDestroyBuffer (self->device, self->staging_buffer, NULL);
+      if (self->staging_memory != VK_NULL_HANDLE)
+        vkFreeMemory (self->device, self->staging_memory, NULL);
+    }
+
+  g_clear_object (&self->context);
+
+  G_OBJECT_CLASS (gxr_texture_uploader_parent_class)->finalize (gobject);
+}
+
+static VkDeviceSize
+_align (VkDeviceSize offset, VkDeviceSize alignment)
+{
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+static struct GxrUploadSubmission *
+_get_oldest_pending (GxrTextureUploader *self)
+{
+  for (uint32_t i = 0; i < UPLOAD_SUBMISSION_COUNT; i++)
+    {
+      uint32_t index = (self->next_submission + i) % UPLOAD_SUBMISSION_COUNT;
+      if (self->submissions[index].pending)
+        return &self->submissions[index];
+    }
+  return NULL;
+}
+
+/*
+ * Finds size contiguous bytes in the staging ring, waiting for the oldest
+ * uploads until their staging ranges are free.
+ */
+static gboolean
+_reserve_staging (GxrTextureUploader *self,
+                  VkDeviceSize        size,
+                  VkDeviceSize        alignment,
+                  VkDeviceSize       *offset)
+{
+  while (TRUE)
+    {
+      struct GxrUploadSubmission *oldest = _get_oldest_pending (self);
+      switch (gxr_staging_ring_reserve (&self->staging_ring, size, alignment,
+                                        oldest ? &oldest->offset : NULL,
+                                        offset))
+        {
+          case GXR_STAGING_RING_RESERVED:
+            return TRUE;
+          case GXR_STAGING_RING_TOO_LARGE:
+            return FALSE;
+          case GXR_STAGING_RING_FULL:
+            _wait_submission (self, oldest);
+            break;
+        }
+    }
+}
+
+/* Rects need to lie within the image, so the copies stay inside pixels. */
+static gboolean
+_rect_in_source (const GxrUploadSource *source, const VkRect2D *rect)
+{
+  return rect->offset.x >= 0 && rect->offset.y >= 0
+         && (uint64_t) rect->offset.x + rect->extent.width <= source->width
+         && (uint64_t) rect->offset.y + rect->extent.height <= source->height;
+}
+
+static gboolean
+_needs_ownership_transfer (GxrTextureUploader *self)
+{
+  return self->transfer_family != self->graphics_family;
+}
+
+/*
+ * Copies the damaged rects of source into the staging ring and records
+ * the copies into the submission. The image is transitioned from
+ * old_layout, and released to the graphics queue family in
+ * VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+ */
+static void
+_record_upload (GxrTextureUploader         *self,
+                struct GxrUploadSubmission *submission,
+                VkImage                     image,
+                VkImageLayout               old_layout,
+                const GxrUploadSource      *source,
+                const VkRect2D             *rects,
+                uint32_t                    rect_count,
+                VkDeviceSize                alignment)
+{
+  VkBufferImageCopy *regions = g_new (VkBufferImageCopy, rect_count);
+  VkDeviceSize       position = submission->offset;
+
+  for (uint32_t i = 0; i < rect_count; i++)
+    {
+      const VkRect2D *rect = &rects[i];
+      size_t          row_size = rect->extent.width * source->bytes_per_pixel;
+      const uint8_t  *src = source->pixels
+                           + (size_t) rect->offset.y * source->stride
+                           + (size_t) rect->offset.x * source->bytes_per_pixel;
+
+      position = _align (position, alignment);
+      for (uint32_t y = 0; y < rect->extent.height; y++)
+        memcpy (self->staging_map + position + y * row_size,
+                src + (size_t) y * source->stride, row_size);
+
+      regions[i] = (VkBufferImageCopy){
+        .bufferOffset = position,
+        .imageSubresource = {
+          .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+          .mipLevel = 0,
+          .baseArrayLayer = 0,
+          .layerCount = 1,
+        },
+        .imageOffset = {rect->offset.x, rect->offset.y, 0},
+        .imageExtent = {rect->extent.width, rect->extent.height, 1},
+      };
+
+      position += row_size * rect->extent.height;
+    }
+
+  /* content in undefined layout is discarded, nothing to acquire */
+  gboolean acquire = _needs_ownership_transfer (self)
+                     && old_layout != VK_IMAGE_LAYOUT_UNDEFINED;
+  gboolean release = _needs_ownership_transfer (self);
+
+  VkImageSubresourceRange range = {
+    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+    .levelCount = 1,
+    .layerCount = 1,
+  };
+
+  VkImageMemoryBarrier to_transfer = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = 0,
+    .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .oldLayout = old_layout,
+    .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    .srcQueueFamilyIndex = acquire ? self->graphics_family
+                                   : VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = acquire ? self->transfer_family
+                                   : VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = range,
+  };
+  vkCmdPipelineBarrier (submission->cmd_buffer,
+                        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1,
+                        &to_transfer);
+
+  vkCmdCopyBufferToImage (submission->cmd_buffer, self->staging_buffer, image,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, rect_count,
+                          regions);
+
+  /* the semaphore makes the copy visible to the graphics queue */
+  VkImageMemoryBarrier to_shader = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .dstAccessMask = 0,
+    .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    .srcQueueFamilyIndex = release ? self->transfer_family
+                                   : VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = release ? self->graphics_family
+                                   : VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = range,
+  };
+  vkCmdPipelineBarrier (submission->cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0,
+                        NULL, 1, &to_shader);
+
+  g_free (regions);
+}
+
+/*
+ * Uploads the damaged rects of source to image on the transfer queue,
+ * without waiting for the copy to complete.
+ *
+ * old_layout is VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL for images that
+ * were uploaded before, or VK_IMAGE_LAYOUT_UNDEFINED if the rects cover the
+ * whole image. Afterwards the image is in
+ * VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+ *
+ * The upload waits for wait_semaphore if it is not VK_NULL_HANDLE, which
+ * is needed when the graphics queue still uses the image. If
+ * signal_semaphore is not NULL, it is set to a semaphore that is signaled
+ * when the upload completes. It needs to be waited on by exactly one
+ * submission before it is reused by a later upload.
+ */
+gboolean
+gxr_texture_uploader_upload (GxrTextureUploader    *self,
+                             VkImage                image,
+                             VkImageLayout          old_layout,
+                             const GxrUploadSource *source,
+                             const VkRect2D        *rects,
+                             uint32_t               rect_count,
+                             VkSemaphore            wait_semaphore,
+                             VkSemaphore           *signal_semaphore)
+{
+  if (signal_semaphore)
+    *signal_semaphore = VK_NULL_HANDLE;
+
+  if (rect_count == 0)
+    return TRUE;
+
+  g_return_val_if_fail ((uint64_t) source->width * source->bytes_per_pixel
+                          <= source->stride,
+                        FALSE);
+  for (uint32_t i = 0; i < rect_count; i++)
+    g_return_val_if_fail (_rect_in_source (source, &rects[i]), FALSE);
+
+  /* copy offsets need to be a multiple of 4 and of the texel size */
+  VkDeviceSize alignment = 4 * source->bytes_per_pixel;
+
+  VkDeviceSize size = 0;
+  for (uint32_t i = 0; i < rect_count; i++)
+    size = _align (size, alignment)
+           + (VkDeviceSize) rects[i].extent.width * rects[i].extent.height
+               * source->bytes_per_pixel;
+
+  struct GxrUploadSubmission *submission
+    = &self->submissions[self->next_submission];
+  _wait_submission (self, submission);
+
+  VkDeviceSize offset;
+  if (!_reserve_staging (self, size, alignment, &offset))
+    {
+      g_printerr ("Upload of %" G_GUINT64_FORMAT " bytes does not fit into "
+                  "the staging ring.\n",
+                  (guint64) size);
+      return FALSE;
+    }
+  submission->offset = offset;
+  submission->size = size;
+
+  vkResetFences (self->device, 1, &submission->fence);
+  vkResetCommandBuffer (submission->cmd_buffer, 0);
+
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  VkResult res = vkBeginCommandBuffer (submission->cmd_buffer, &begin_info);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not begin upload command buffer: %d\n", res);
+      return FALSE;
+    }
+
+  _record_upload (self, submission, image, old_layout, source, rects,
+                  rect_count, alignment);
+
+  res = vkEndCommandBuffer (submission->cmd_buffer);
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not end upload command buffer: %d\n", res);
+      return FALSE;
+    }
+
+  VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  VkSubmitInfo         submit_info = {
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .waitSemaphoreCount = wait_semaphore != VK_NULL_HANDLE ? 1 : 0,
+    .pWaitSemaphores = &wait_semaphore,
+    .pWaitDstStageMask = &wait_stage,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &submission->cmd_buffer,
+    .signalSemaphoreCount = signal_semaphore ? 1 : 0,
+    .pSignalSemaphores = &submission->semaphore,
+  };
+
+  GMutex *mutex = gulkan_queue_get_pool_mutex (self->queue);
+  g_mutex_lock (mutex);
+  res = vkQueueSubmit (gulkan_queue_get_handle (self->queue), 1, &submit_info,
+                       submission->fence);
+  g_mutex_unlock (mutex);
+
+  if (res != VK_SUCCESS)
+    {
+      g_printerr ("Could not submit upload: %d\n", res);
+      return FALSE;
+    }
+
+  submission->pending = TRUE;
+  self->next_submission = (self->next_submission + 1)
+                          % UPLOAD_SUBMISSION_COUNT;
+
+  if (signal_semaphore)
+    *signal_semaphore = submission->semaphore;
+
+  return TRUE;
+}
+
+/*
+ * Records the graphics side of the ownership transfer of an uploaded
+ * image, before it is sampled in cmd_buffer. Nothing is recorded when
+ * transfer and graphics queue are of the same family.
+ */
+void
+gxr_texture_uploader_record_acquire (GxrTextureUploader *self,
+                                     VkCommandBuffer     cmd_buffer,
+                                     VkImage             image)
+{
+  if (!_needs_ownership_transfer (self))
+    return;
+
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = 0,
+    .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+    .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    .srcQueueFamilyIndex = self->transfer_family,
+    .dstQueueFamilyIndex = self->graphics_family,
+    .image = image,
+    .subresourceRange = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .levelCount = 1,
+      .layerCount = 1,
+    },
+  };
+  vkCmdPipelineBarrier (cmd_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0,
+                        NULL, 1, &barrier);
+}
+
+/*
+ * Records the graphics side of handing the image back to the transfer
+ * queue, after its last use in cmd_buffer before the next partial upload.
+ */
+void
+gxr_texture_uploader_record_release (GxrTextureUploader *self,
+                                     VkCommandBuffer     cmd_buffer,
+                                     VkImage             image)
+{
+  if (!_needs_ownership_transfer (self))
+    return;
+
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = 0,
+    .dstAccessMask = 0,
+    .oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    .srcQueueFamilyIndex = self->graphics_family,
+    .dstQueueFamilyIndex = self->transfer_family,
+    .image = image,
+    .subresourceRange = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .levelCount = 1,
+      .layerCount = 1,
+    },
+  };
+  vkCmdPipelineBarrier (cmd_buffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0,
+                        NULL, 1, &barrier);
+}
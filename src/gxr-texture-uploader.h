@@ -0,0 +1,77 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_TEXTURE_UPLOADER_H_
+#define GXR_TEXTURE_UPLOADER_H_
+
+#if !defined(GXR_INSIDE) && !defined(GXR_COMPILATION)
+#error "Only <gxr.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gulkan.h>
+#include <stdint.h>
+
+#include "gxr-context.h"
+
+G_BEGIN_DECLS
+
+#define GXR_TYPE_TEXTURE_UPLOADER gxr_texture_uploader_get_type ()
+G_DECLARE_FINAL_TYPE (GxrTextureUploader,
+                      gxr_texture_uploader,
+                      GXR,
+                      TEXTURE_UPLOADER,
+                      GObject)
+
+/**
+ * GxrUploadSource:
+ * @pixels: The CPU pixel buffer of the whole image.
+ * @stride: The length of a row in @pixels in bytes.
+ * @bytes_per_pixel: The texel size of the image format.
+ * @width: The width of the image in pixels.
+ * @height: The height of the image in pixels.
+ *
+ * Pixels to upload to an image with gxr_texture_uploader_upload(). The
+ * uploaded rects need to lie within @width and @height.
+ **/
+typedef struct
+{
+  const uint8_t *pixels;
+  uint32_t       stride;
+  uint32_t       bytes_per_pixel;
+  uint32_t       width;
+  uint32_t       height;
+} GxrUploadSource;
+
+GxrTextureUploader *
+gxr_texture_uploader_new (GxrContext *context, VkDeviceSize staging_size);
+
+gboolean
+gxr_texture_uploader_upload (GxrTextureUploader    *self,
+                             VkImage                image,
+                             VkImageLayout          old_layout,
+                             const GxrUploadSource *source,
+                             const VkRect2D        *rects,
+                             uint32_t               rect_count,
+                             VkSemaphore            wait_semaphore,
+                             VkSemaphore           *signal_semaphore);
+
+void
+gxr_texture_uploader_record_acquire (GxrTextureUploader *self,
+                                     VkCommandBuffer     cmd_buffer,
+                                     VkImage             image);
+
+void
+gxr_texture_uploader_record_release (GxrTextureUploader *self,
+                                     VkCommandBuffer     cmd_buffer,
+                                     VkImage             image);
+
+void
+gxr_texture_uploader_wait_idle (GxrTextureUploader *self);
+
+G_END_DECLS
+
+#endif /* GXR_TEXTURE_UPLOADER_H_ */
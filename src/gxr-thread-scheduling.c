@@ -0,0 +1,85 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#define _GNU_SOURCE
+
+#include "gxr-thread-scheduling.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static void
+_set_affinity (uint64_t cpu_mask)
+{
+  cpu_set_t set;
+  CPU_ZERO (&set);
+  for (int cpu = 0; cpu < 64; cpu++)
+    if (cpu_mask & (G_GUINT64_CONSTANT (1) << cpu))
+      CPU_SET (cpu, &set);
+
+  int err = pthread_setaffinity_np (pthread_self (), sizeof (set), &set);
+  if (err != 0)
+    g_printerr ("Could not set CPU affinity: %s\n", strerror (err));
+}
+
+static gboolean
+_set_realtime (const GxrThreadConfig *config)
+{
+  int policy = config->round_robin ? SCHED_RR : SCHED_FIFO;
+
+  struct sched_param param = {
+    .sched_priority = CLAMP (config->priority, sched_get_priority_min (policy),
+                             sched_get_priority_max (policy)),
+  };
+
+  int err = pthread_setschedparam (pthread_self (), policy, &param);
+  if (err != 0)
+    {
+      g_debug ("Realtime scheduling not permitted: %s", strerror (err));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* On Linux, the nice value of a thread is set with its thread id. */
+static gboolean
+_set_nice (int nice)
+{
+  pid_t tid = (pid_t) syscall (SYS_gettid);
+  if (setpriority (PRIO_PROCESS, (id_t) tid, nice) != 0)
+    {
+      g_debug ("Could not set nice level %d: %s", nice, strerror (errno));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * Applies config to the calling thread. Realtime scheduling usually needs
+ * CAP_SYS_NICE or an RLIMIT_RTPRIO, a negative nice level needs a raised
+ * RLIMIT_NICE. Returns the scheduling that was granted.
+ */
+GxrThreadScheduling
+gxr_thread_scheduling_apply (const GxrThreadConfig *config)
+{
+  if (config->cpu_mask != 0)
+    _set_affinity (config->cpu_mask);
+
+  if (config->realtime && _set_realtime (config))
+    return GXR_THREAD_SCHEDULING_REALTIME;
+
+  if (config->nice != 0 && _set_nice (config->nice))
+    return GXR_THREAD_SCHEDULING_NICE;
+
+  return GXR_THREAD_SCHEDULING_DEFAULT;
+}
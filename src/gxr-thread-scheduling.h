@@ -0,0 +1,17 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_THREAD_SCHEDULING_H_
+#define GXR_THREAD_SCHEDULING_H_
+
+#include <glib.h>
+
+#include "gxr-context.h"
+
+GxrThreadScheduling
+gxr_thread_scheduling_apply (const GxrThreadConfig *config);
+
+#endif /* GXR_THREAD_SCHEDULING_H_ */
@@ -0,0 +1,323 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gxr-visibility-mask.h"
+
+#include <gio/gio.h>
+#include <math.h>
+#include <string.h>
+
+static void
+_printerr_xr_result (XrInstance instance, XrResult result)
+{
+  char buffer[XR_MAX_RESULT_STRING_SIZE];
+  xrResultToString (instance, result, buffer);
+  g_printerr ("%s\n", buffer);
+}
+
+/* Replaces the mesh with the hidden triangle mesh of view_index. */
+gboolean
+gxr_visibility_mask_fetch (GxrVisibilityMask      *self,
+                           XrInstance              instance,
+                           XrSession               session,
+                           XrViewConfigurationType view_config_type,
+                           uint32_t                view_index)
+{
+  gxr_visibility_mask_clear (self);
+
+  PFN_xrGetVisibilityMaskKHR GetVisibilityMaskKHR = NULL;
+  XrResult result
+    = xrGetInstanceProcAddr (instance, "xrGetVisibilityMaskKHR",
+                             (PFN_xrVoidFunction *) &GetVisibilityMaskKHR);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to load xrGetVisibilityMaskKHR: ");
+      _printerr_xr_result (instance, result);
+      return FALSE;
+    }
+
+  XrVisibilityMaskKHR mask = {
+    .type = XR_TYPE_VISIBILITY_MASK_KHR,
+  };
+  result = GetVisibilityMaskKHR (
+    session, view_config_type, view_index,
+    XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR, &mask);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to get visibility mask size: ");
+      _printerr_xr_result (instance, result);
+      return FALSE;
+    }
+
+  /* runtimes without a mask return an empty one */
+  if (mask.vertexCountOutput == 0 || mask.indexCountOutput == 0)
+    return TRUE;
+
+  self->vertices = g_new (XrVector2f, mask.vertexCountOutput);
+  self->indices = g_new (uint32_t, mask.indexCountOutput);
+
+  mask.vertexCapacityInput = mask.vertexCountOutput;
+  mask.vertices = self->vertices;
+  mask.indexCapacityInput = mask.indexCountOutput;
+  mask.indices = self->indices;
+
+  result = GetVisibilityMaskKHR (
+    session, view_config_type, view_index,
+    XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR, &mask);
+  if (result != XR_SUCCESS)
+    {
+      g_printerr ("Failed to get visibility mask: ");
+      _printerr_xr_result (instance, result);
+      gxr_visibility_mask_clear (self);
+      return FALSE;
+    }
+
+  self->vertex_count = mask.vertexCountOutput;
+  self->index_count = mask.indexCountOutput;
+
+  return TRUE;
+}
+
+void
+gxr_visibility_mask_clear (GxrVisibilityMask *self)
+{
+  g_clear_pointer (&self->vertices, g_free);
+  g_clear_pointer (&self->indices, g_free);
+  self->vertex_count = 0;
+  self->index_count = 0;
+}
+
+/*
+ * Writes the triangles as a non indexed list of vertices with
+ * GXR_VISIBILITY_MASK_VERTEX_SIZE components each, projected with the
+ * same projection as gxr_context_get_projection. vertices needs space for
+ * index_count vertices. Returns the number of vertices written.
+ */
+uint32_t
+gxr_visibility_mask_write_mesh (const GxrVisibilityMask *self,
+                                XrFovf                   fov,
+                                uint32_t                 view_index,
+                                float                   *vertices)
+{
+  const float tan_left = tanf (fov.angleLeft);
+  const float tan_right = tanf (fov.angleRight);
+  const float tan_down = tanf (fov.angleDown);
+  const float tan_up = tanf (fov.angleUp);
+
+  const float tan_width = tan_right - tan_left;
+  const float tan_height = tan_up - tan_down;
+
+  uint32_t count = 0;
+  for (uint32_t i = 0; i + 2 < self->index_count; i += 3)
+    {
+      const uint32_t *triangle = &self->indices[i];
+      if (triangle[0] >= self->vertex_count || triangle[1] >= self->vertex_count
+          || triangle[2] >= self->vertex_count)
+        continue;
+
+      for (uint32_t j = 0; j < 3; j++)
+        {
+          const XrVector2f *v = &self->vertices[triangle[j]];
+          float *out = &vertices[count * GXR_VISIBILITY_MASK_VERTEX_SIZE];
+
+          out[0] = (2.0f * v->x - (tan_right + tan_left)) / tan_width;
+          out[1] = (2.0f * v->y - (tan_up + tan_down)) / tan_height;
+          /* the near plane, so nothing behind it passes a less depth test */
+          out[2] = 0.0f;
+          out[3] = (float) view_index;
+          count++;
+        }
+    }
+
+  return count;
+}
+
+static gboolean
+_create_shader_module (VkDevice device, const char *uri, VkShaderModule *module)
+{
+  GError *error = NULL;
+  GBytes *bytes = g_resources_lookup_data (uri, G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                           &error);
+  if (!bytes)
+    {
+      g_printerr ("Could not load shader %s: %s\n", uri, error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  /* resource data is not guaranteed to be aligned for SPIR-V words */
+  gsize         size;
+  gconstpointer data = g_bytes_get_data (bytes, &size);
+  uint32_t     *code = g_malloc (size);
+  memcpy (code, data, size);
+  g_bytes_unref (bytes);
+
+  VkShaderModuleCreateInfo info = {
+    .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+    .codeSize = size,
+    .pCode = code,
+  };
+  VkResult result = vkCreateShaderModule (device, &info, NULL, module);
+  g_free (code);
+
+  if (result != VK_SUCCESS)
+    {
+      g_printerr ("Could not create shader module %s\n", uri);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * Creates a multiview pipeline that draws the mesh of write_mesh into the
+ * depth buffer only, at the near plane. Viewport and scissor are dynamic.
+ */
+gboolean
+gxr_visibility_mask_create_pipeline (VkDevice              device,
+                                     VkRenderPass          render_pass,
+                                     VkSampleCountFlagBits sample_count,
+                                     VkPipelineLayout     *layout,
+                                     VkPipeline           *pipeline)
+{
+  VkShaderModule vertex_module;
+  VkShaderModule fragment_module;
+  if (!_create_shader_module (device, "/gxr/shaders/visibility-mask.vert.spv",
+                              &vertex_module))
+    return FALSE;
+  if (!_create_shader_module (device, "/gxr/shaders/visibility-mask.frag.spv",
+                              &fragment_module))
+    {
+      vkDestroyShaderModule (device, vertex_module, NULL);
+      return FALSE;
+    }
+
+  VkPipelineLayoutCreateInfo layout_info = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+  };
+  VkResult result = vkCreatePipelineLayout (device, &layout_info, NULL,
+                                            layout);
+  if (result != VK_SUCCESS)
+    {
+      vkDestroyShaderModule (device, vertex_module, NULL);
+      vkDestroyShaderModule (device, fragment_module, NULL);
+      return FALSE;
+    }
+
+  VkPipelineShaderStageCreateInfo stages[] = {
+    {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .stage = VK_SHADER_STAGE_VERTEX_BIT,
+      .module = vertex_module,
+      .pName = "main",
+    },
+    {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+      .module = fragment_module,
+      .pName = "main",
+    },
+  };
+
+  VkVertexInputBindingDescription binding = {
+    .binding = 0,
+    .stride = sizeof (float) * GXR_VISIBILITY_MASK_VERTEX_SIZE,
+    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+  };
+  VkVertexInputAttributeDescription attribute = {
+    .location = 0,
+    .binding = 0,
+    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+  };
+  VkPipelineVertexInputStateCreateInfo vertex_input = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+    .vertexBindingDescriptionCount = 1,
+    .pVertexBindingDescriptions = &binding,
+    .vertexAttributeDescriptionCount = 1,
+    .pVertexAttributeDescriptions = &attribute,
+  };
+
+  VkPipelineInputAssemblyStateCreateInfo input_assembly = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+    .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+  };
+
+  VkPipelineViewportStateCreateInfo viewport = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+    .viewportCount = 1,
+    .scissorCount = 1,
+  };
+
+  /* the winding of the runtime mesh is not specified */
+  VkPipelineRasterizationStateCreateInfo rasterization = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+    .polygonMode = VK_POLYGON_MODE_FILL,
+    .cullMode = VK_CULL_MODE_NONE,
+    .lineWidth = 1.0f,
+  };
+
+  VkPipelineMultisampleStateCreateInfo multisample = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+    .rasterizationSamples = sample_count,
+  };
+
+  VkPipelineDepthStencilStateCreateInfo depth_stencil = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+    .depthTestEnable = VK_TRUE,
+    .depthWriteEnable = VK_TRUE,
+    .depthCompareOp = VK_COMPARE_OP_ALWAYS,
+  };
+
+  /* the render pass has a color attachment, which is left untouched */
+  VkPipelineColorBlendAttachmentState blend_attachment = {
+    .colorWriteMask = 0,
+  };
+  VkPipelineColorBlendStateCreateInfo blend = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+    .attachmentCount = 1,
+    .pAttachments = &blend_attachment,
+  };
+
+  VkDynamicState dynamic_states[] = {
+    VK_DYNAMIC_STATE_VIEWPORT,
+    VK_DYNAMIC_STATE_SCISSOR,
+  };
+  VkPipelineDynamicStateCreateInfo dynamic = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+    .dynamicStateCount = G_N_ELEMENTS (dynamic_states),
+    .pDynamicStates = dynamic_states,
+  };
+
+  VkGraphicsPipelineCreateInfo pipeline_info = {
+    .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+    .stageCount = G_N_ELEMENTS (stages),
+    .pStages = stages,
+    .pVertexInputState = &vertex_input,
+    .pInputAssemblyState = &input_assembly,
+    .pViewportState = &viewport,
+    .pRasterizationState = &rasterization,
+    .pMultisampleState = &multisample,
+    .pDepthStencilState = &depth_stencil,
+    .pColorBlendState = &blend,
+    .pDynamicState = &dynamic,
+    .layout = *layout,
+    .renderPass = render_pass,
+  };
+  result = vkCreateGraphicsPipelines (device, VK_NULL_HANDLE, 1,
+                                      &pipeline_info, NULL, pipeline);
+
+  vkDestroyShaderModule (device, vertex_module, NULL);
+  vkDestroyShaderModule (device, fragment_module, NULL);
+
+  if (result != VK_SUCCESS)
+    {
+      vkDestroyPipelineLayout (device, *layout, NULL);
+      *layout = VK_NULL_HANDLE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
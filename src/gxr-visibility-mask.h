@@ -0,0 +1,50 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GXR_VISIBILITY_MASK_H_
+#define GXR_VISIBILITY_MASK_H_
+
+#include <glib.h>
+#include <openxr/openxr.h>
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+/* Components of a mesh vertex: NDC x, y, depth and the view index */
+#define GXR_VISIBILITY_MASK_VERTEX_SIZE 4
+
+/* Hidden triangle mesh of a view, on the plane at z = -1 of the view */
+typedef struct
+{
+  XrVector2f *vertices;
+  uint32_t    vertex_count;
+  uint32_t   *indices;
+  uint32_t    index_count;
+} GxrVisibilityMask;
+
+gboolean
+gxr_visibility_mask_fetch (GxrVisibilityMask      *self,
+                           XrInstance              instance,
+                           XrSession               session,
+                           XrViewConfigurationType view_config_type,
+                           uint32_t                view_index);
+
+void
+gxr_visibility_mask_clear (GxrVisibilityMask *self);
+
+uint32_t
+gxr_visibility_mask_write_mesh (const GxrVisibilityMask *self,
+                                XrFovf                   fov,
+                                uint32_t                 view_index,
+                                float                   *vertices);
+
+gboolean
+gxr_visibility_mask_create_pipeline (VkDevice              device,
+                                     VkRenderPass          render_pass,
+                                     VkSampleCountFlagBits sample_count,
+                                     VkPipelineLayout     *layout,
+                                     VkPipeline           *pipeline);
+
+#endif /* GXR_VISIBILITY_MASK_H_ */
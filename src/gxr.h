@@ -18,10 +18,17 @@
 #include "gxr-action.h"
 #include "gxr-context.h"
 #include "gxr-controller.h"
+#include "gxr-cylinder-layer.h"
 #include "gxr-device-manager.h"
 #include "gxr-device.h"
+#include "gxr-equirect-layer.h"
+#include "gxr-external-image.h"
 #include "gxr-io.h"
+#include "gxr-layer.h"
 #include "gxr-manifest.h"
+#include "gxr-quad-layer.h"
+#include "gxr-rigid-pose.h"
+#include "gxr-texture-uploader.h"
 #include "gxr-version.h"
 
 #undef GXR_INSIDE
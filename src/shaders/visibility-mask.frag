@@ -0,0 +1,13 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#version 460 core
+
+/* only depth is written, color writes are masked in the pipeline */
+void
+main ()
+{
+}
@@ -0,0 +1,22 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#version 460 core
+
+#extension GL_EXT_multiview : enable
+
+/* x, y and depth in normalized device coordinates, w the view in the pair */
+layout (location = 0) in vec4 in_position;
+
+void
+main ()
+{
+  /* all vertices of the other view collapse to one point outside clip space */
+  if (int (in_position.w) != gl_ViewIndex)
+    gl_Position = vec4 (2.0, 2.0, 2.0, 1.0);
+  else
+    gl_Position = vec4 (in_position.xyz, 1.0);
+}
@@ -0,0 +1,107 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+
+#include "gxr.h"
+
+#include "gxr-atlas-packer.h"
+
+static gboolean
+_overlaps (const VkRect2D *a, const VkRect2D *b)
+{
+  return a->offset.x < b->offset.x + (int32_t) b->extent.width
+         && b->offset.x < a->offset.x + (int32_t) a->extent.width
+         && a->offset.y < b->offset.y + (int32_t) b->extent.height
+         && b->offset.y < a->offset.y + (int32_t) a->extent.height;
+}
+
+static void
+_test_packs_without_overlap ()
+{
+  VkExtent2D      extent = {1024, 1024};
+  GxrAtlasPacker *packer = gxr_atlas_packer_new (extent);
+
+  VkExtent2D sizes[] = {
+    {300, 200}, {500, 100}, {200, 200}, {400, 300},
+    {1024, 50}, {100, 100}, {600, 250}, {250, 90},
+  };
+  VkRect2D rects[G_N_ELEMENTS (sizes)];
+
+  for (uint32_t i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      g_assert_true (gxr_atlas_packer_alloc (packer, sizes[i], &rects[i]));
+      g_assert_cmpint (rects[i].offset.x + (int32_t) rects[i].extent.width,
+                       <=, (int32_t) extent.width);
+      g_assert_cmpint (rects[i].offset.y + (int32_t) rects[i].extent.height,
+                       <=, (int32_t) extent.height);
+      for (uint32_t j = 0; j < i; j++)
+        g_assert_false (_overlaps (&rects[i], &rects[j]));
+    }
+
+  gxr_atlas_packer_free (packer);
+}
+
+static void
+_test_rejects_when_full ()
+{
+  GxrAtlasPacker *packer = gxr_atlas_packer_new ((VkExtent2D){512, 512});
+
+  VkRect2D rect;
+  g_assert_false (gxr_atlas_packer_alloc (packer, (VkExtent2D){513, 10},
+                                          &rect));
+  g_assert_false (gxr_atlas_packer_alloc (packer, (VkExtent2D){0, 10},
+                                          &rect));
+
+  for (uint32_t i = 0; i < 4; i++)
+    g_assert_true (gxr_atlas_packer_alloc (packer, (VkExtent2D){256, 256},
+                                           &rect));
+  g_assert_false (gxr_atlas_packer_alloc (packer, (VkExtent2D){1, 1}, &rect));
+
+  gxr_atlas_packer_clear (packer);
+  g_assert_true (gxr_atlas_packer_alloc (packer, (VkExtent2D){512, 512},
+                                         &rect));
+
+  gxr_atlas_packer_free (packer);
+}
+
+static void
+_test_reuses_released_shelves ()
+{
+  GxrAtlasPacker *packer = gxr_atlas_packer_new ((VkExtent2D){512, 512});
+
+  VkRect2D top, bottom_a, bottom_b;
+  g_assert_true (gxr_atlas_packer_alloc (packer, (VkExtent2D){512, 256},
+                                         &top));
+  g_assert_true (gxr_atlas_packer_alloc (packer, (VkExtent2D){256, 256},
+                                         &bottom_a));
+  g_assert_true (gxr_atlas_packer_alloc (packer, (VkExtent2D){256, 256},
+                                         &bottom_b));
+
+  /* space on a shelf comes back once the whole shelf is empty */
+  VkRect2D rect;
+  gxr_atlas_packer_release (packer, &bottom_a);
+  g_assert_false (gxr_atlas_packer_alloc (packer, (VkExtent2D){256, 256},
+                                          &rect));
+  gxr_atlas_packer_release (packer, &bottom_b);
+
+  /* the empty bottom shelf is removed, so a taller rect fits again */
+  gxr_atlas_packer_release (packer, &top);
+  g_assert_true (gxr_atlas_packer_alloc (packer, (VkExtent2D){100, 512},
+                                         &rect));
+  g_assert_cmpint (rect.offset.y, ==, 0);
+
+  gxr_atlas_packer_free (packer);
+}
+
+int
+main ()
+{
+  _test_packs_without_overlap ();
+  _test_rejects_when_full ();
+  _test_reuses_released_shelves ();
+  return 0;
+}
@@ -31,10 +31,92 @@ _test_quit_event ()
   g_print ("Exit completed\n");
 }
 
+static void
+_run_frames (GxrContext *context, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+    {
+      gxr_context_poll_events (context);
+      g_assert_true (gxr_context_wait_frame (context));
+      g_assert_true (gxr_context_begin_frame (context));
+      g_assert_true (gxr_context_end_frame (context, 0.1f, 1.0f, 0.0f, 1.0f));
+    }
+}
+
+static void
+_test_pipelined_frames ()
+{
+  GxrContext *context = gxr_context_new ("Test Context", 1);
+  g_assert_nonnull (context);
+
+  g_assert_true (gxr_context_set_pipelined (context, TRUE));
+  g_assert_true (gxr_context_is_pipelined (context));
+  _run_frames (context, 10);
+
+  /* the frame the thread waited for ahead is handed over, not lost */
+  g_assert_true (gxr_context_set_pipelined (context, FALSE));
+  g_assert_false (gxr_context_is_pipelined (context));
+  _run_frames (context, 10);
+
+  g_assert_true (gxr_context_set_pipelined (context, TRUE));
+  _run_frames (context, 10);
+
+  GxrFrameStats stats;
+  gxr_context_get_frame_stats (context, &stats);
+  g_assert_cmpuint (stats.frame_count, ==, 30);
+
+  g_object_unref (context);
+}
+
+static void
+_test_quad_views ()
+{
+  g_setenv ("GXR_VIEW_CONFIG", "QUAD", TRUE);
+  GxrContext *context = gxr_context_new ("Test Context", 1);
+  g_unsetenv ("GXR_VIEW_CONFIG");
+  g_assert_nonnull (context);
+
+  uint32_t view_count = gxr_context_get_view_count (context);
+  if (view_count != 4)
+    {
+      g_print ("Runtime has no quad views, skipping.\n");
+      g_assert_cmpuint (view_count, ==, 2);
+      g_assert_cmpuint (gxr_context_get_view_pair_count (context), ==, 1);
+      g_object_unref (context);
+      return;
+    }
+  g_assert_cmpuint (gxr_context_get_view_pair_count (context), ==, 2);
+
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      gxr_context_poll_events (context);
+      g_assert_true (gxr_context_wait_frame (context));
+      g_assert_true (gxr_context_begin_frame (context));
+
+      for (GxrEye eye = GXR_EYE_LEFT; eye <= GXR_EYE_RIGHT_INSET; eye++)
+        {
+          graphene_matrix_t projection;
+          graphene_matrix_t view;
+          gxr_context_get_projection (context, eye, 0.1f, 1.0f, &projection);
+          gxr_context_get_view (context, eye, &view);
+        }
+
+      g_assert_true (gxr_context_end_frame (context, 0.1f, 1.0f, 0.0f, 1.0f));
+    }
+
+  GxrFrameStats stats;
+  gxr_context_get_frame_stats (context, &stats);
+  g_assert_cmpuint (stats.frame_count, ==, 10);
+
+  g_object_unref (context);
+}
+
 int
 main ()
 {
   _test_init_context ();
   _test_quit_event ();
+  _test_pipelined_frames ();
+  _test_quad_views ();
   return 0;
 }
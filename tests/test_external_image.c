@@ -0,0 +1,525 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+#include <gulkan.h>
+#include <string.h>
+
+#include "gxr.h"
+
+#define WIDTH 64
+#define HEIGHT 32
+#define IMAGE_SIZE (WIDTH * HEIGHT * 4)
+
+#define USAGE                                                                  \
+  (VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT                \
+   | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+
+static uint32_t
+_find_memory_type (VkPhysicalDevice      physical_device,
+                   uint32_t              type_bits,
+                   VkMemoryPropertyFlags flags)
+{
+  VkPhysicalDeviceMemoryProperties properties;
+  vkGetPhysicalDeviceMemoryProperties (physical_device, &properties);
+
+  for (uint32_t i = 0; i < properties.memoryTypeCount; i++)
+    if ((type_bits & (1u << i))
+        && (properties.memoryTypes[i].propertyFlags & flags) == flags)
+      return i;
+
+  return 0;
+}
+
+/* A host visible buffer to copy the pattern from and the result into. */
+static gboolean
+_create_host_buffer (VkDevice            device,
+                     VkPhysicalDevice    physical_device,
+                     VkBufferUsageFlags  usage,
+                     VkBuffer           *buffer,
+                     VkDeviceMemory     *memory,
+                     uint8_t           **map)
+{
+  VkBufferCreateInfo buffer_info = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    .size = IMAGE_SIZE,
+    .usage = usage,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+  };
+  if (vkCreateBuffer (device, &buffer_info, NULL, buffer) != VK_SUCCESS)
+    return FALSE;
+
+  VkMemoryRequirements requirements;
+  vkGetBufferMemoryRequirements (device, *buffer, &requirements);
+
+  VkMemoryAllocateInfo alloc_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+    .allocationSize = requirements.size,
+    .memoryTypeIndex
+    = _find_memory_type (physical_device, requirements.memoryTypeBits,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                           | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+  };
+  if (vkAllocateMemory (device, &alloc_info, NULL, memory) != VK_SUCCESS)
+    return FALSE;
+  if (vkBindBufferMemory (device, *buffer, *memory, 0) != VK_SUCCESS)
+    return FALSE;
+
+  return vkMapMemory (device, *memory, 0, VK_WHOLE_SIZE, 0, (void **) map)
+         == VK_SUCCESS;
+}
+
+static void
+_write_pattern (uint8_t *pixels)
+{
+  for (uint32_t y = 0; y < HEIGHT; y++)
+    for (uint32_t x = 0; x < WIDTH; x++)
+      {
+        uint8_t *pixel = &pixels[(y * WIDTH + x) * 4];
+        pixel[0] = (uint8_t) (x * 4);
+        pixel[1] = (uint8_t) (y * 8);
+        pixel[2] = (uint8_t) (x ^ y);
+        pixel[3] = 255;
+      }
+}
+
+static void
+_record_layout_barrier (VkCommandBuffer      cmd_buffer,
+                        VkImage              image,
+                        VkImageLayout        old_layout,
+                        VkImageLayout        new_layout,
+                        VkAccessFlags        src_access,
+                        VkAccessFlags        dst_access,
+                        VkPipelineStageFlags src_stage,
+                        VkPipelineStageFlags dst_stage)
+{
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = src_access,
+    .dstAccessMask = dst_access,
+    .oldLayout = old_layout,
+    .newLayout = new_layout,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .levelCount = 1,
+      .layerCount = 1,
+    },
+  };
+  vkCmdPipelineBarrier (cmd_buffer, src_stage, dst_stage, 0, 0, NULL, 0, NULL,
+                        1, &barrier);
+}
+
+static VkBufferImageCopy
+_get_copy_region ()
+{
+  return (VkBufferImageCopy){
+    .imageSubresource = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .layerCount = 1,
+    },
+    .imageExtent = {WIDTH, HEIGHT, 1},
+  };
+}
+
+static void
+_submit_and_wait (VkDevice device, GulkanQueue *queue, VkCommandBuffer cmd)
+{
+  VkSubmitInfo submit_info = {
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &cmd,
+  };
+  g_assert_true (vkQueueSubmit (gulkan_queue_get_handle (queue), 1,
+                                &submit_info, VK_NULL_HANDLE)
+                 == VK_SUCCESS);
+  vkDeviceWaitIdle (device);
+}
+
+/* A resettable command buffer from a pool on the queue's family. */
+static void
+_create_command_buffer (VkDevice         device,
+                        GulkanQueue     *queue,
+                        VkCommandPool   *pool,
+                        VkCommandBuffer *cmd_buffer)
+{
+  VkCommandPoolCreateInfo pool_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+    .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+    .queueFamilyIndex = gulkan_queue_get_family_index (queue),
+  };
+  g_assert_true (vkCreateCommandPool (device, &pool_info, NULL, pool)
+                 == VK_SUCCESS);
+
+  VkCommandBufferAllocateInfo alloc_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+    .commandPool = *pool,
+    .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+    .commandBufferCount = 1,
+  };
+  g_assert_true (vkAllocateCommandBuffers (device, &alloc_info, cmd_buffer)
+                 == VK_SUCCESS);
+}
+
+static void
+_begin_commands (VkCommandBuffer cmd_buffer)
+{
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  vkResetCommandBuffer (cmd_buffer, 0);
+  vkBeginCommandBuffer (cmd_buffer, &begin_info);
+}
+
+/* The producer writes the pattern and leaves the image in general layout. */
+static void
+_upload_pattern (VkDevice        device,
+                 GulkanQueue    *queue,
+                 VkCommandBuffer cmd_buffer,
+                 VkBuffer        pattern_buffer,
+                 VkImage         image)
+{
+  VkBufferImageCopy region = _get_copy_region ();
+  _begin_commands (cmd_buffer);
+  _record_layout_barrier (cmd_buffer, image, VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                          VK_ACCESS_TRANSFER_WRITE_BIT,
+                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT);
+  vkCmdCopyBufferToImage (cmd_buffer, pattern_buffer, image,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+  _record_layout_barrier (cmd_buffer, image,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_TRANSFER_WRITE_BIT,
+                          VK_ACCESS_MEMORY_READ_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+  vkEndCommandBuffer (cmd_buffer);
+  _submit_and_wait (device, queue, cmd_buffer);
+}
+
+static void
+_record_host_read_barrier (VkCommandBuffer cmd_buffer, VkBuffer buffer)
+{
+  VkBufferMemoryBarrier to_host = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+    .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .buffer = buffer,
+    .size = VK_WHOLE_SIZE,
+  };
+  vkCmdPipelineBarrier (cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &to_host, 0,
+                        NULL);
+}
+
+/* Exports an image like a capture service in another process would. */
+static gboolean
+_export_image (VkDevice         device,
+               VkPhysicalDevice physical_device,
+               VkImage         *image,
+               VkDeviceMemory  *memory,
+               VkDeviceSize    *size,
+               int             *fd)
+{
+  VkExternalMemoryImageCreateInfo external_info = {
+    .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+    .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT,
+  };
+  VkImageCreateInfo image_info = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+    .pNext = &external_info,
+    .imageType = VK_IMAGE_TYPE_2D,
+    .format = VK_FORMAT_R8G8B8A8_UNORM,
+    .extent = {WIDTH, HEIGHT, 1},
+    .mipLevels = 1,
+    .arrayLayers = 1,
+    .samples = VK_SAMPLE_COUNT_1_BIT,
+    .tiling = VK_IMAGE_TILING_OPTIMAL,
+    .usage = USAGE,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+  if (vkCreateImage (device, &image_info, NULL, image) != VK_SUCCESS)
+    return FALSE;
+
+  VkMemoryRequirements requirements;
+  vkGetImageMemoryRequirements (device, *image, &requirements);
+
+  VkMemoryDedicatedAllocateInfo dedicated_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+    .image = *image,
+  };
+  VkExportMemoryAllocateInfo export_info = {
+    .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
+    .pNext = &dedicated_info,
+    .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT,
+  };
+  VkMemoryAllocateInfo alloc_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+    .pNext = &export_info,
+    .allocationSize = requirements.size,
+    .memoryTypeIndex = _find_memory_type (physical_device,
+                                          requirements.memoryTypeBits,
+                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+  };
+  if (vkAllocateMemory (device, &alloc_info, NULL, memory) != VK_SUCCESS)
+    return FALSE;
+  if (vkBindImageMemory (device, *image, *memory, 0) != VK_SUCCESS)
+    return FALSE;
+
+  PFN_vkGetMemoryFdKHR GetMemoryFdKHR = (PFN_vkGetMemoryFdKHR)
+    vkGetDeviceProcAddr (device, "vkGetMemoryFdKHR");
+  if (!GetMemoryFdKHR)
+    return FALSE;
+
+  VkMemoryGetFdInfoKHR fd_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
+    .memory = *memory,
+    .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT,
+  };
+  if (GetMemoryFdKHR (device, &fd_info, fd) != VK_SUCCESS)
+    return FALSE;
+
+  *size = requirements.size;
+  return TRUE;
+}
+
+static void
+_test_import_opaque_fd ()
+{
+  GSList *instance_ext_list
+    = gulkan_context_get_external_memory_instance_extensions ();
+  GSList *device_ext_list
+    = gulkan_context_get_external_memory_device_extensions ();
+
+  GulkanContext *context
+    = gulkan_context_new_from_extensions (instance_ext_list, device_ext_list,
+                                          VK_NULL_HANDLE);
+  g_slist_free_full (instance_ext_list, g_free);
+  g_slist_free_full (device_ext_list, g_free);
+  g_assert_nonnull (context);
+
+  GulkanDevice    *gulkan_device = gulkan_context_get_device (context);
+  VkDevice         device = gulkan_device_get_handle (gulkan_device);
+  VkPhysicalDevice physical_device
+    = gulkan_device_get_physical_handle (gulkan_device);
+
+  VkImage        exported_image;
+  VkDeviceMemory exported_memory;
+  VkDeviceSize   size;
+  int            fd;
+  g_assert_true (_export_image (device, physical_device, &exported_image,
+                                &exported_memory, &size, &fd));
+
+  VkBuffer       pattern_buffer;
+  VkDeviceMemory pattern_memory;
+  uint8_t       *pattern;
+  g_assert_true (_create_host_buffer (device, physical_device,
+                                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                      &pattern_buffer, &pattern_memory,
+                                      &pattern));
+  _write_pattern (pattern);
+
+  VkBuffer       readback_buffer;
+  VkDeviceMemory readback_memory;
+  uint8_t       *readback;
+  g_assert_true (_create_host_buffer (device, physical_device,
+                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      &readback_buffer, &readback_memory,
+                                      &readback));
+  memset (readback, 0, IMAGE_SIZE);
+
+  GulkanQueue    *queue = gulkan_device_get_graphics_queue (gulkan_device);
+  VkCommandPool   pool;
+  VkCommandBuffer cmd_buffer;
+  _create_command_buffer (device, queue, &pool, &cmd_buffer);
+
+  _upload_pattern (device, queue, cmd_buffer, pattern_buffer, exported_image);
+
+  GxrExternalImageInfo info = {
+    .fd = fd,
+    .handle_type = GXR_EXTERNAL_HANDLE_OPAQUE_FD,
+    .extent = {WIDTH, HEIGHT},
+    .format = VK_FORMAT_R8G8B8A8_UNORM,
+    .usage = USAGE,
+    .allocation_size = size,
+  };
+  GxrExternalImage *image = gxr_external_image_new_from_fd (context, &info);
+  g_assert_nonnull (image);
+  g_assert_true (gxr_external_image_get_image (image) != VK_NULL_HANDLE);
+  g_assert_true (gxr_external_image_get_image_view (image) != VK_NULL_HANDLE);
+  g_assert_cmpuint (gxr_external_image_get_extent (image).width, ==, WIDTH);
+
+  /* the ownership transfer orders the read after the producer wrote */
+  VkBufferImageCopy region = _get_copy_region ();
+  _begin_commands (cmd_buffer);
+  gxr_external_image_record_acquire (image, cmd_buffer,
+                                     VK_IMAGE_LAYOUT_GENERAL,
+                                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+  vkCmdCopyImageToBuffer (cmd_buffer, gxr_external_image_get_image (image),
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          readback_buffer, 1, &region);
+  gxr_external_image_record_release (image, cmd_buffer,
+                                     VK_IMAGE_LAYOUT_GENERAL);
+  _record_host_read_barrier (cmd_buffer, readback_buffer);
+  vkEndCommandBuffer (cmd_buffer);
+  _submit_and_wait (device, queue, cmd_buffer);
+
+  /* the imported image aliases the memory the pattern was written to */
+  g_assert_cmpmem (readback, IMAGE_SIZE, pattern, IMAGE_SIZE);
+
+  vkDestroyCommandPool (device, pool, NULL);
+  vkDestroyBuffer (device, pattern_buffer, NULL);
+  vkFreeMemory (device, pattern_memory, NULL);
+  vkDestroyBuffer (device, readback_buffer, NULL);
+  vkFreeMemory (device, readback_memory, NULL);
+  g_object_unref (image);
+  vkDestroyImage (device, exported_image, NULL);
+  vkFreeMemory (device, exported_memory, NULL);
+  g_object_unref (context);
+}
+
+/*
+ * Blits an imported image into a layer image the runtime handed out, which
+ * is then read back. Needs a runtime for the layer swapchain.
+ */
+static void
+_test_blit_to_layer ()
+{
+  GSList *instance_ext_list
+    = gulkan_context_get_external_memory_instance_extensions ();
+  GSList *device_ext_list
+    = gulkan_context_get_external_memory_device_extensions ();
+
+  GxrContext *context
+    = gxr_context_new_from_vulkan_extensions (instance_ext_list,
+                                              device_ext_list,
+                                              "Test External Image", 1);
+  g_slist_free_full (instance_ext_list, g_free);
+  g_slist_free_full (device_ext_list, g_free);
+  g_assert_nonnull (context);
+
+  GulkanContext   *gulkan = gxr_context_get_gulkan (context);
+  GulkanDevice    *gulkan_device = gulkan_context_get_device (gulkan);
+  VkDevice         device = gulkan_device_get_handle (gulkan_device);
+  VkPhysicalDevice physical_device
+    = gulkan_device_get_physical_handle (gulkan_device);
+
+  VkImage        exported_image;
+  VkDeviceMemory exported_memory;
+  VkDeviceSize   size;
+  int            fd;
+  g_assert_true (_export_image (device, physical_device, &exported_image,
+                                &exported_memory, &size, &fd));
+
+  VkBuffer       pattern_buffer;
+  VkDeviceMemory pattern_memory;
+  uint8_t       *pattern;
+  g_assert_true (_create_host_buffer (device, physical_device,
+                                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                      &pattern_buffer, &pattern_memory,
+                                      &pattern));
+  _write_pattern (pattern);
+
+  VkBuffer       readback_buffer;
+  VkDeviceMemory readback_memory;
+  uint8_t       *readback;
+  g_assert_true (_create_host_buffer (device, physical_device,
+                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      &readback_buffer, &readback_memory,
+                                      &readback));
+  memset (readback, 0, IMAGE_SIZE);
+
+  GulkanQueue    *queue = gulkan_device_get_graphics_queue (gulkan_device);
+  VkCommandPool   pool;
+  VkCommandBuffer cmd_buffer;
+  _create_command_buffer (device, queue, &pool, &cmd_buffer);
+
+  _upload_pattern (device, queue, cmd_buffer, pattern_buffer, exported_image);
+
+  GxrExternalImageInfo info = {
+    .fd = fd,
+    .handle_type = GXR_EXTERNAL_HANDLE_OPAQUE_FD,
+    .extent = {WIDTH, HEIGHT},
+    .format = VK_FORMAT_R8G8B8A8_UNORM,
+    .usage = USAGE,
+    .allocation_size = size,
+  };
+  GxrExternalImage *image = gxr_external_image_new_from_fd (gulkan, &info);
+  g_assert_nonnull (image);
+
+  /* mipmapped layer images can be transfer sources, so they can be read */
+  GxrQuadLayer *quad
+    = gxr_quad_layer_new_mipmapped (context, (VkExtent2D){WIDTH, HEIGHT},
+                                    VK_FORMAT_R8G8B8A8_UNORM, 2);
+  g_assert_nonnull (quad);
+  GxrLayer *layer = GXR_LAYER (quad);
+
+  uint32_t index;
+  g_assert_true (gxr_layer_acquire (layer, &index));
+  VkImage layer_image = gxr_layer_get_image (layer, index);
+
+  VkBufferImageCopy region = _get_copy_region ();
+  _begin_commands (cmd_buffer);
+  gxr_external_image_record_acquire (image, cmd_buffer,
+                                     VK_IMAGE_LAYOUT_GENERAL,
+                                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+  g_assert_true (
+    gxr_external_image_record_blit_to_layer (image, cmd_buffer, layer));
+  gxr_external_image_record_release (image, cmd_buffer,
+                                     VK_IMAGE_LAYOUT_GENERAL);
+
+  /* the blit leaves the layer image as color attachment */
+  _record_layout_barrier (cmd_buffer, layer_image,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                          VK_ACCESS_TRANSFER_READ_BIT,
+                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT);
+  vkCmdCopyImageToBuffer (cmd_buffer, layer_image,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          readback_buffer, 1, &region);
+  _record_layout_barrier (cmd_buffer, layer_image,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                          VK_ACCESS_TRANSFER_READ_BIT, 0,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+  _record_host_read_barrier (cmd_buffer, readback_buffer);
+  vkEndCommandBuffer (cmd_buffer);
+  _submit_and_wait (device, queue, cmd_buffer);
+
+  g_assert_true (gxr_layer_release (layer));
+
+  /* same extent and format, so the blit copies the pattern unchanged */
+  g_assert_cmpmem (readback, IMAGE_SIZE, pattern, IMAGE_SIZE);
+
+  vkDestroyCommandPool (device, pool, NULL);
+  vkDestroyBuffer (device, pattern_buffer, NULL);
+  vkFreeMemory (device, pattern_memory, NULL);
+  vkDestroyBuffer (device, readback_buffer, NULL);
+  vkFreeMemory (device, readback_memory, NULL);
+  g_object_unref (layer);
+  g_object_unref (image);
+  vkDestroyImage (device, exported_image, NULL);
+  vkFreeMemory (device, exported_memory, NULL);
+  g_object_unref (context);
+}
+
+int
+main ()
+{
+  _test_import_opaque_fd ();
+  _test_blit_to_layer ();
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+
+#include "gxr.h"
+
+#include "gxr-frame-history.h"
+
+#define PERIOD_NS 11111111
+
+static GxrFrameTimestamps
+_make_frame (int64_t display_time, int64_t start, int64_t work)
+{
+  GxrFrameTimestamps frame = {
+    .wait_start = start,
+    .wait_end = start + 100,
+    .begin_start = start + 100,
+    .begin_end = start + 200,
+    .end_start = start + 100 + work - 50,
+    .end_end = start + 100 + work,
+    .predicted_display_time = display_time,
+    .predicted_display_period = PERIOD_NS,
+  };
+  return frame;
+}
+
+static void
+_test_percentiles ()
+{
+  GxrFrameHistory history;
+  gxr_frame_history_init (&history);
+
+  /* work durations 1000, 2000, ... 100000 */
+  for (int64_t i = 0; i < 100; i++)
+    {
+      GxrFrameTimestamps frame = _make_frame (i * PERIOD_NS, i * 11111,
+                                              (i + 1) * 1000);
+      g_assert_cmpuint (gxr_frame_history_push (&history, &frame), ==, 0);
+    }
+
+  GxrFrameStats stats;
+  gxr_frame_history_get_stats (&history, &stats);
+
+  g_assert_cmpuint (stats.frame_count, ==, 100);
+  g_assert_cmpuint (stats.missed_frames, ==, 0);
+  g_assert_cmpint (stats.predicted_display_period, ==, PERIOD_NS / 1000);
+
+  g_assert_cmpint (stats.work.p50, ==, 50000);
+  g_assert_cmpint (stats.work.p90, ==, 90000);
+  g_assert_cmpint (stats.work.p99, ==, 99000);
+  g_assert_cmpint (stats.work.max, ==, 100000);
+  g_assert_cmpint (stats.remaining_budget, ==, PERIOD_NS / 1000 - 90000);
+
+  g_assert_cmpint (stats.phases[GXR_FRAME_PHASE_WAIT].max, ==, 100);
+  g_assert_cmpint (stats.phases[GXR_FRAME_PHASE_BEGIN].p50, ==, 100);
+  g_assert_cmpint (stats.phases[GXR_FRAME_PHASE_END].p99, ==, 50);
+}
+
+static void
+_test_ring_wraps ()
+{
+  GxrFrameHistory history;
+  gxr_frame_history_init (&history);
+
+  for (int64_t i = 0; i < GXR_FRAME_HISTORY_SIZE * 3; i++)
+    {
+      /* only the last GXR_FRAME_HISTORY_SIZE frames take 5 ms */
+      int64_t            work = i < GXR_FRAME_HISTORY_SIZE * 2 ? 1000 : 5000;
+      GxrFrameTimestamps frame = _make_frame (i * PERIOD_NS, 0, work);
+      gxr_frame_history_push (&history, &frame);
+    }
+
+  GxrFrameStats stats;
+  gxr_frame_history_get_stats (&history, &stats);
+  g_assert_cmpuint (stats.frame_count, ==, GXR_FRAME_HISTORY_SIZE);
+  g_assert_cmpint (stats.work.p50, ==, 5000);
+  g_assert_cmpint (gxr_frame_history_get_work_percentile (&history, 0.0f), ==,
+                   5000);
+}
+
+static void
+_test_missed_frames ()
+{
+  GxrFrameHistory history;
+  gxr_frame_history_init (&history);
+
+  GxrFrameTimestamps frame = _make_frame (0, 0, 1000);
+  g_assert_cmpuint (gxr_frame_history_push (&history, &frame), ==, 0);
+
+  /* slightly late prediction is not a miss */
+  frame = _make_frame (PERIOD_NS + PERIOD_NS / 10, 0, 1000);
+  g_assert_cmpuint (gxr_frame_history_push (&history, &frame), ==, 0);
+
+  /* skipped two display periods */
+  frame.predicted_display_time += 3 * PERIOD_NS;
+  g_assert_cmpuint (gxr_frame_history_push (&history, &frame), ==, 2);
+
+  frame.predicted_display_time += 2 * PERIOD_NS;
+  g_assert_cmpuint (gxr_frame_history_push (&history, &frame), ==, 1);
+
+  GxrFrameStats stats;
+  gxr_frame_history_get_stats (&history, &stats);
+  g_assert_cmpuint (stats.missed_frames, ==, 3);
+}
+
+static void
+_test_unknown_gpu_time ()
+{
+  GxrFrameHistory history;
+  gxr_frame_history_init (&history);
+
+  /* a GPU time is only reported for every fourth frame */
+  for (int64_t i = 0; i < 40; i++)
+    {
+      GxrFrameTimestamps frame = _make_frame (i * PERIOD_NS, i * 11111, 1000);
+      if (i % 4 == 0)
+        frame.gpu_duration = 3000 + i;
+      gxr_frame_history_push (&history, &frame);
+    }
+
+  GxrFrameStats stats;
+  gxr_frame_history_get_stats (&history, &stats);
+  g_assert_cmpint (stats.phases[GXR_FRAME_PHASE_GPU].p50, >=, 3000);
+  g_assert_cmpint (stats.phases[GXR_FRAME_PHASE_GPU].max, ==, 3036);
+  g_assert_cmpint (gxr_frame_history_get_percentile (&history,
+                                                     GXR_FRAME_PHASE_GPU,
+                                                     0.0f),
+                   ==, 3000);
+}
+
+int
+main ()
+{
+  _test_percentiles ();
+  _test_ring_wraps ();
+  _test_missed_frames ();
+  _test_unknown_gpu_time ();
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+#include <math.h>
+
+#include "gxr.h"
+
+#include "gxr-pose-service.h"
+
+#define WRITES 100000
+
+static void
+_test_read_published ()
+{
+  GxrPoseService service;
+  gxr_pose_service_init (&service);
+
+  GxrSpaceRelation relation = {
+    .location = {
+      .locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT,
+      .pose = {.orientation = {0, 0, 0, 1}, .position = {1, 2, 3}},
+    },
+  };
+  GxrSpaceRelation result;
+  int64_t          time;
+
+  g_assert_false (gxr_pose_service_read (&service, 0, &result, &time));
+
+  gxr_pose_service_begin_write (&service, 1000);
+  gxr_pose_service_write (&service, 1, &relation);
+  gxr_pose_service_end_write (&service);
+
+  g_assert_true (gxr_pose_service_read (&service, 1, &result, &time));
+  g_assert_cmpint (time, ==, 1000);
+  g_assert_cmpfloat (result.location.pose.position.y, ==, 2.0f);
+
+  g_assert_false (gxr_pose_service_read (&service, GXR_POSE_SERVICE_MAX_SLOTS,
+                                         &result, &time));
+}
+
+static void
+_test_extrapolate ()
+{
+  GxrSpaceRelation relation = {
+    .location = {
+      .pose = {.orientation = {0, 0, 0, 1}, .position = {0, 1, 0}},
+    },
+    .velocity = {
+      .velocityFlags = XR_SPACE_VELOCITY_LINEAR_VALID_BIT
+                       | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT,
+      .linearVelocity = {2, 0, 0},
+      .angularVelocity = {0, (float) G_PI, 0},
+    },
+  };
+
+  float error = gxr_space_relation_extrapolate (&relation, 0.5f);
+
+  g_assert_cmpfloat_with_epsilon (relation.location.pose.position.x, 1.0f,
+                                  1e-6f);
+  g_assert_cmpfloat_with_epsilon (relation.location.pose.position.y, 1.0f,
+                                  1e-6f);
+
+  /* a quarter turn around y */
+  XrQuaternionf *q = &relation.location.pose.orientation;
+  g_assert_cmpfloat_with_epsilon (q->y, sinf ((float) G_PI / 4.0f), 1e-6f);
+  g_assert_cmpfloat_with_epsilon (q->w, cosf ((float) G_PI / 4.0f), 1e-6f);
+
+  g_assert_cmpfloat (error, >, 0.0f);
+  g_assert_cmpfloat (error, <, 5.0f);
+}
+
+static gpointer
+_read_func (gpointer data)
+{
+  GxrPoseService *service = data;
+
+  for (int i = 0; i < WRITES; i++)
+    {
+      GxrSpaceRelation result;
+      int64_t          time;
+      if (!gxr_pose_service_read (service, 0, &result, &time))
+        continue;
+
+      /* a torn read would mix two writes */
+      g_assert_cmpfloat (result.location.pose.position.x, ==, (float) time);
+      g_assert_cmpfloat (result.location.pose.position.z, ==, (float) time);
+    }
+
+  return NULL;
+}
+
+static void
+_test_concurrent_reads ()
+{
+  GxrPoseService service;
+  gxr_pose_service_init (&service);
+
+  GThread *reader = g_thread_new ("reader", _read_func, &service);
+
+  for (int64_t i = 1; i <= WRITES; i++)
+    {
+      GxrSpaceRelation relation = {
+        .location.pose.position = {(float) i, 0, (float) i},
+      };
+      gxr_pose_service_begin_write (&service, i);
+      gxr_pose_service_write (&service, 0, &relation);
+      gxr_pose_service_end_write (&service);
+    }
+
+  g_thread_join (reader);
+}
+
+int
+main ()
+{
+  _test_read_published ();
+  _test_extrapolate ();
+  _test_concurrent_reads ();
+  return 0;
+}
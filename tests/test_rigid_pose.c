@@ -0,0 +1,122 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+#include <math.h>
+
+#include "gxr.h"
+
+#define EPSILON 1e-5f
+
+static void
+_assert_matrix_near (const graphene_matrix_t *a, const graphene_matrix_t *b)
+{
+  float fa[16];
+  float fb[16];
+  graphene_matrix_to_float (a, fa);
+  graphene_matrix_to_float (b, fb);
+  for (int i = 0; i < 16; i++)
+    g_assert_cmpfloat_with_epsilon (fa[i], fb[i], EPSILON);
+}
+
+static void
+_init_pose (GxrRigidPose *pose,
+            float         angle,
+            float         axis_x,
+            float         axis_y,
+            float         x,
+            float         y,
+            float         z)
+{
+  graphene_vec3_t axis;
+  graphene_vec3_init (&axis, axis_x, axis_y, 0);
+  graphene_vec3_normalize (&axis, &axis);
+
+  graphene_quaternion_t orientation;
+  graphene_quaternion_init_from_angle_vec3 (&orientation, angle, &axis);
+
+  graphene_vec3_t position;
+  graphene_vec3_init (&position, x, y, z);
+
+  gxr_rigid_pose_init (pose, &orientation, &position);
+}
+
+static void
+_test_matches_matrices ()
+{
+  GxrRigidPose a, b;
+  _init_pose (&a, 30.0f, 0, 1, 1, 2, 3);
+  _init_pose (&b, 75.0f, 1, 1, -2, 0, 0.5f);
+
+  graphene_matrix_t ma, mb;
+  gxr_rigid_pose_to_matrix (&a, &ma);
+  gxr_rigid_pose_to_matrix (&b, &mb);
+
+  GxrRigidPose      ab;
+  graphene_matrix_t mab, expected;
+  gxr_rigid_pose_multiply (&a, &b, &ab);
+  gxr_rigid_pose_to_matrix (&ab, &mab);
+  graphene_matrix_multiply (&ma, &mb, &expected);
+  _assert_matrix_near (&mab, &expected);
+
+  GxrRigidPose      inverse;
+  graphene_matrix_t minverse;
+  gxr_rigid_pose_inverse (&a, &inverse);
+  gxr_rigid_pose_to_matrix (&inverse, &minverse);
+  graphene_matrix_inverse (&ma, &expected);
+  _assert_matrix_near (&minverse, &expected);
+
+  graphene_point3d_t p = {.x = 0.5f, .y = -1.0f, .z = 2.0f};
+  graphene_point3d_t transformed, expected_point;
+  gxr_rigid_pose_transform_point (&a, &p, &transformed);
+  graphene_matrix_transform_point3d (&ma, &p, &expected_point);
+  g_assert_cmpfloat_with_epsilon (transformed.x, expected_point.x, EPSILON);
+  g_assert_cmpfloat_with_epsilon (transformed.y, expected_point.y, EPSILON);
+  g_assert_cmpfloat_with_epsilon (transformed.z, expected_point.z, EPSILON);
+}
+
+static void
+_test_inverse_cancels ()
+{
+  GxrRigidPose pose, inverse, identity;
+  _init_pose (&pose, 120.0f, 1, 0, 0, 1.7f, -4);
+  gxr_rigid_pose_inverse (&pose, &inverse);
+  gxr_rigid_pose_multiply (&pose, &inverse, &identity);
+
+  graphene_matrix_t m, expected;
+  gxr_rigid_pose_to_matrix (&identity, &m);
+  graphene_matrix_init_identity (&expected);
+  _assert_matrix_near (&m, &expected);
+}
+
+static void
+_test_from_xr ()
+{
+  /* a quarter turn around y */
+  float   s = sqrtf (0.5f);
+  XrPosef xr_pose = {
+    .orientation = {0, s, 0, s},
+    .position = {1, 2, 3},
+  };
+
+  GxrRigidPose pose;
+  gxr_rigid_pose_init_from_xr (&pose, &xr_pose);
+
+  graphene_point3d_t p = {.x = 1.0f, .y = 0.0f, .z = 0.0f};
+  gxr_rigid_pose_transform_point (&pose, &p, &p);
+  g_assert_cmpfloat_with_epsilon (p.x, 1.0f, EPSILON);
+  g_assert_cmpfloat_with_epsilon (p.y, 2.0f, EPSILON);
+  g_assert_cmpfloat_with_epsilon (p.z, 2.0f, EPSILON);
+}
+
+int
+main ()
+{
+  _test_matches_matrices ();
+  _test_inverse_cancels ();
+  _test_from_xr ();
+  return 0;
+}
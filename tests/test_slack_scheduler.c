@@ -0,0 +1,130 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+
+#include "gxr.h"
+
+#include "gxr-slack-scheduler.h"
+
+typedef struct
+{
+  uint32_t runs;
+  uint32_t chunks;
+  gulong   duration;
+  gboolean destroyed;
+} Task;
+
+static gboolean
+_task_cb (gpointer data)
+{
+  Task *task = data;
+  task->runs++;
+  if (task->duration > 0)
+    g_usleep (task->duration);
+  return task->runs < task->chunks;
+}
+
+static void
+_task_destroy (gpointer data)
+{
+  Task *task = data;
+  task->destroyed = TRUE;
+}
+
+static void
+_test_runs_within_budget ()
+{
+  GxrSlackScheduler *scheduler = gxr_slack_scheduler_new ();
+
+  Task a = {.chunks = 1};
+  Task b = {.chunks = 3};
+  gxr_slack_scheduler_add (scheduler, _task_cb, &a, _task_destroy);
+  gxr_slack_scheduler_add (scheduler, _task_cb, &b, _task_destroy);
+
+  /* no budget left, everything is carried over */
+  g_assert_cmpuint (gxr_slack_scheduler_run (scheduler,
+                                             g_get_monotonic_time ()),
+                    ==, 0);
+  g_assert_cmpuint (gxr_slack_scheduler_get_pending (scheduler), ==, 2);
+
+  int64_t deadline = g_get_monotonic_time () + G_USEC_PER_SEC;
+  g_assert_cmpuint (gxr_slack_scheduler_run (scheduler, deadline), ==, 2);
+  g_assert_true (a.destroyed);
+  g_assert_false (b.destroyed);
+  g_assert_cmpuint (gxr_slack_scheduler_get_pending (scheduler), ==, 1);
+
+  /* chunked task runs once per run until it is done */
+  deadline = g_get_monotonic_time () + G_USEC_PER_SEC;
+  gxr_slack_scheduler_run (scheduler, deadline);
+  gxr_slack_scheduler_run (scheduler, deadline);
+  g_assert_cmpuint (b.runs, ==, 3);
+  g_assert_true (b.destroyed);
+  g_assert_cmpuint (gxr_slack_scheduler_get_pending (scheduler), ==, 0);
+
+  gxr_slack_scheduler_free (scheduler);
+}
+
+static void
+_test_carries_over_slow_tasks ()
+{
+  GxrSlackScheduler *scheduler = gxr_slack_scheduler_new ();
+
+  Task slow = {.chunks = 2, .duration = 20000};
+  Task fast = {.chunks = 2};
+  gxr_slack_scheduler_add (scheduler, _task_cb, &slow, _task_destroy);
+  gxr_slack_scheduler_add (scheduler, _task_cb, &fast, _task_destroy);
+
+  int64_t deadline = g_get_monotonic_time () + G_USEC_PER_SEC;
+  g_assert_cmpuint (gxr_slack_scheduler_run (scheduler, deadline), ==, 2);
+
+  /* the slow task is known to take longer than the budget now */
+  deadline = g_get_monotonic_time () + 5000;
+  g_assert_cmpuint (gxr_slack_scheduler_run (scheduler, deadline), ==, 1);
+  g_assert_cmpuint (slow.runs, ==, 1);
+  g_assert_cmpuint (fast.runs, ==, 2);
+  g_assert_cmpuint (gxr_slack_scheduler_get_pending (scheduler), ==, 1);
+
+  gxr_slack_scheduler_free (scheduler);
+  g_assert_true (slow.destroyed);
+}
+
+static void
+_test_runs_oversized_tasks_eventually ()
+{
+  GxrSlackScheduler *scheduler = gxr_slack_scheduler_new ();
+
+  Task slow = {.chunks = 2, .duration = 20000};
+  gxr_slack_scheduler_add (scheduler, _task_cb, &slow, _task_destroy);
+
+  int64_t deadline = g_get_monotonic_time () + G_USEC_PER_SEC;
+  g_assert_cmpuint (gxr_slack_scheduler_run (scheduler, deadline), ==, 1);
+
+  /* never fits the slack, skipped until it aged enough */
+  for (uint32_t i = 0; i < GXR_SLACK_TASK_MAX_SKIPS; i++)
+    {
+      deadline = g_get_monotonic_time () + 5000;
+      g_assert_cmpuint (gxr_slack_scheduler_run (scheduler, deadline), ==, 0);
+    }
+  g_assert_cmpuint (slow.runs, ==, 1);
+
+  deadline = g_get_monotonic_time () + 5000;
+  g_assert_cmpuint (gxr_slack_scheduler_run (scheduler, deadline), ==, 1);
+  g_assert_cmpuint (slow.runs, ==, 2);
+  g_assert_true (slow.destroyed);
+  g_assert_cmpuint (gxr_slack_scheduler_get_pending (scheduler), ==, 0);
+
+  gxr_slack_scheduler_free (scheduler);
+}
+
+int
+main ()
+{
+  _test_runs_within_budget ();
+  _test_carries_over_slow_tasks ();
+  _test_runs_oversized_tasks_eventually ();
+  return 0;
+}
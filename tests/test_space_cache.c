@@ -0,0 +1,84 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+
+#include "gxr.h"
+
+#include "gxr-space-cache.h"
+
+#define SPACE(i) ((XrSpace) (uintptr_t) (i))
+
+static void
+_test_hits_and_misses ()
+{
+  GxrSpaceCache cache;
+  gxr_space_cache_init (&cache);
+
+  GxrSpaceRelation relation = {
+    .location = {
+      .locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT,
+      .pose = {.orientation = {0, 0, 0, 1}, .position = {1, 2, 3}},
+    },
+  };
+  GxrSpaceRelation result;
+
+  gxr_space_cache_set_time (&cache, 100);
+  g_assert_false (
+    gxr_space_cache_lookup (&cache, SPACE (1), SPACE (2), 100, &result));
+  gxr_space_cache_insert (&cache, SPACE (1), SPACE (2), 100, &relation);
+
+  g_assert_true (
+    gxr_space_cache_lookup (&cache, SPACE (1), SPACE (2), 100, &result));
+  g_assert_cmpfloat (result.location.pose.position.z, ==, 3.0f);
+
+  /* the relation is directed */
+  g_assert_false (
+    gxr_space_cache_lookup (&cache, SPACE (2), SPACE (1), 100, &result));
+
+  g_assert_cmpuint (cache.hits, ==, 1);
+  g_assert_cmpuint (cache.misses, ==, 2);
+
+  gxr_space_cache_clear (&cache);
+}
+
+static void
+_test_invalidates_on_new_time ()
+{
+  GxrSpaceCache cache;
+  gxr_space_cache_init (&cache);
+
+  GxrSpaceRelation relation = {0};
+  GxrSpaceRelation result;
+
+  gxr_space_cache_set_time (&cache, 100);
+  gxr_space_cache_insert (&cache, SPACE (1), SPACE (2), 100, &relation);
+  gxr_space_cache_set_time (&cache, 200);
+
+  g_assert_false (
+    gxr_space_cache_peek (&cache, SPACE (1), SPACE (2), &result));
+  g_assert_false (
+    gxr_space_cache_lookup (&cache, SPACE (1), SPACE (2), 200, &result));
+
+  /* predictions at other times do not replace the frame's relations */
+  gxr_space_cache_insert (&cache, SPACE (1), SPACE (2), 300, &relation);
+  g_assert_false (
+    gxr_space_cache_peek (&cache, SPACE (1), SPACE (2), &result));
+
+  gxr_space_cache_insert (&cache, SPACE (1), SPACE (2), 200, &relation);
+  g_assert_true (
+    gxr_space_cache_lookup (&cache, SPACE (1), SPACE (2), 200, &result));
+
+  gxr_space_cache_clear (&cache);
+}
+
+int
+main ()
+{
+  _test_hits_and_misses ();
+  _test_invalidates_on_new_time ();
+  return 0;
+}
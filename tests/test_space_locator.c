@@ -0,0 +1,113 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+
+#include "gxr.h"
+
+#include "gxr-space-locator.h"
+
+#define SPACE(i) ((XrSpace) (uintptr_t) (i))
+
+static void
+_assert_packed (GxrSpaceLocator *locator,
+                const XrSpace   *expected,
+                uint32_t         expected_count)
+{
+  const XrSpace                *spaces;
+  const XrSpaceLocationDataKHR *locations;
+  const XrSpaceVelocityDataKHR *velocities;
+
+  uint32_t count = gxr_space_locator_get_located (locator, &spaces, &locations,
+                                                  &velocities);
+  g_assert_cmpuint (count, ==, expected_count);
+
+  for (uint32_t i = 0; i < expected_count; i++)
+    {
+      gboolean found = FALSE;
+      for (uint32_t j = 0; j < count; j++)
+        if (spaces[j] == expected[i])
+          found = TRUE;
+      g_assert_true (found);
+    }
+}
+
+static void
+_test_remove_middle ()
+{
+  GxrSpaceLocator *locator = gxr_space_locator_new (XR_NULL_HANDLE,
+                                                    XR_NULL_HANDLE, FALSE);
+  g_assert_false (gxr_space_locator_is_batched (locator));
+
+  uint32_t slots[4];
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      slots[i] = gxr_space_locator_add (locator, SPACE (i + 1));
+      g_assert_cmpuint (slots[i], ==, i);
+    }
+
+  /* the last space moves into the gap, its slot still finds it */
+  gxr_space_locator_remove (locator, slots[1]);
+  g_assert_true (gxr_space_locator_get_space (locator, slots[1])
+                 == XR_NULL_HANDLE);
+  g_assert_false (gxr_space_locator_contains (locator, SPACE (2)));
+  g_assert_true (gxr_space_locator_get_space (locator, slots[0]) == SPACE (1));
+  g_assert_true (gxr_space_locator_get_space (locator, slots[2]) == SPACE (3));
+  g_assert_true (gxr_space_locator_get_space (locator, slots[3]) == SPACE (4));
+
+  XrSpace remaining[] = {SPACE (1), SPACE (3), SPACE (4)};
+  _assert_packed (locator, remaining, G_N_ELEMENTS (remaining));
+
+  /* removing twice or an unknown slot is ignored */
+  gxr_space_locator_remove (locator, slots[1]);
+  gxr_space_locator_remove (locator, 42);
+  _assert_packed (locator, remaining, G_N_ELEMENTS (remaining));
+
+  gxr_space_locator_free (locator);
+}
+
+static void
+_test_reuses_slots ()
+{
+  GxrSpaceLocator *locator = gxr_space_locator_new (XR_NULL_HANDLE,
+                                                    XR_NULL_HANDLE, FALSE);
+
+  for (uint32_t i = 0; i < 3; i++)
+    gxr_space_locator_add (locator, SPACE (i + 1));
+
+  gxr_space_locator_remove (locator, 0);
+  gxr_space_locator_remove (locator, 1);
+
+  /* freed slots are handed out again, lowest first */
+  g_assert_cmpuint (gxr_space_locator_add (locator, SPACE (4)), ==, 0);
+  g_assert_cmpuint (gxr_space_locator_add (locator, SPACE (5)), ==, 1);
+  g_assert_cmpuint (gxr_space_locator_add (locator, SPACE (6)), ==, 3);
+
+  g_assert_true (gxr_space_locator_get_space (locator, 0) == SPACE (4));
+  g_assert_true (gxr_space_locator_get_space (locator, 1) == SPACE (5));
+  g_assert_true (gxr_space_locator_get_space (locator, 2) == SPACE (3));
+  g_assert_true (gxr_space_locator_get_space (locator, 3) == SPACE (6));
+
+  XrSpace spaces[] = {SPACE (3), SPACE (4), SPACE (5), SPACE (6)};
+  _assert_packed (locator, spaces, G_N_ELEMENTS (spaces));
+
+  /* the last packed space is removed without moving another one */
+  gxr_space_locator_remove (locator, 3);
+  g_assert_true (gxr_space_locator_get_space (locator, 0) == SPACE (4));
+  g_assert_true (gxr_space_locator_get_space (locator, 1) == SPACE (5));
+  g_assert_true (gxr_space_locator_get_space (locator, 2) == SPACE (3));
+  _assert_packed (locator, spaces, 3);
+
+  gxr_space_locator_free (locator);
+}
+
+int
+main ()
+{
+  _test_remove_middle ();
+  _test_reuses_slots ();
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+
+#include "gxr.h"
+
+#include "gxr-staging-ring.h"
+
+static void
+_test_wraps_around ()
+{
+  GxrStagingRing ring;
+  gxr_staging_ring_init (&ring, 1024);
+
+  VkDeviceSize offset;
+  g_assert_cmpint (gxr_staging_ring_reserve (&ring, 600, 4, NULL, &offset),
+                   ==, GXR_STAGING_RING_RESERVED);
+  g_assert_cmpuint (offset, ==, 0);
+
+  /* aligned after the previous range */
+  VkDeviceSize tail = 0;
+  g_assert_cmpint (gxr_staging_ring_reserve (&ring, 200, 16, &tail, &offset),
+                   ==, GXR_STAGING_RING_RESERVED);
+  g_assert_cmpuint (offset, ==, 608);
+
+  /* no room at the end, wraps to the free start once the first is done */
+  tail = 608;
+  g_assert_cmpint (gxr_staging_ring_reserve (&ring, 300, 4, &tail, &offset),
+                   ==, GXR_STAGING_RING_RESERVED);
+  g_assert_cmpuint (offset, ==, 0);
+
+  /* after wrapping, ranges need to end before the tail */
+  g_assert_cmpint (gxr_staging_ring_reserve (&ring, 200, 4, &tail, &offset),
+                   ==, GXR_STAGING_RING_RESERVED);
+  g_assert_cmpuint (offset, ==, 300);
+}
+
+static void
+_test_full_ring_waits ()
+{
+  GxrStagingRing ring;
+  gxr_staging_ring_init (&ring, 1024);
+
+  VkDeviceSize offset;
+  g_assert_cmpint (gxr_staging_ring_reserve (&ring, 1000, 4, NULL, &offset),
+                   ==, GXR_STAGING_RING_RESERVED);
+
+  /* neither fits after the head nor before the tail */
+  VkDeviceSize tail = 0;
+  g_assert_cmpint (gxr_staging_ring_reserve (&ring, 100, 4, &tail, &offset),
+                   ==, GXR_STAGING_RING_FULL);
+  g_assert_cmpuint (ring.head, ==, 1000);
+
+  /* the wrapped head caught up with the tail */
+  ring.head = 500;
+  tail = 500;
+  g_assert_cmpint (gxr_staging_ring_reserve (&ring, 4, 4, &tail, &offset),
+                   ==, GXR_STAGING_RING_FULL);
+
+  /* the whole ring is free once nothing is pending */
+  g_assert_cmpint (gxr_staging_ring_reserve (&ring, 1024, 4, NULL, &offset),
+                   ==, GXR_STAGING_RING_RESERVED);
+  g_assert_cmpuint (offset, ==, 0);
+}
+
+static void
+_test_rejects_oversized ()
+{
+  GxrStagingRing ring;
+  gxr_staging_ring_init (&ring, 1024);
+
+  VkDeviceSize offset;
+  g_assert_cmpint (gxr_staging_ring_reserve (&ring, 1025, 4, NULL, &offset),
+                   ==, GXR_STAGING_RING_TOO_LARGE);
+  g_assert_cmpuint (ring.head, ==, 0);
+}
+
+int
+main ()
+{
+  _test_wraps_around ();
+  _test_full_ring_waits ();
+  _test_rejects_oversized ();
+  return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ * gxr
+ * Copyright 2026 Collabora Ltd.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <glib.h>
+#include <math.h>
+
+#include "gxr.h"
+
+#include "gxr-visibility-mask.h"
+
+static void
+_test_corners_map_to_ndc ()
+{
+  XrFovf fov = {
+    .angleLeft = -0.8f,
+    .angleRight = 0.7f,
+    .angleUp = 0.75f,
+    .angleDown = -0.9f,
+  };
+
+  /* a triangle on the corners of the tangent rect, one out of range */
+  XrVector2f vertices[] = {
+    {tanf (fov.angleLeft), tanf (fov.angleDown)},
+    {tanf (fov.angleRight), tanf (fov.angleDown)},
+    {tanf (fov.angleRight), tanf (fov.angleUp)},
+  };
+  uint32_t indices[] = {0, 1, 2, 0, 1, 3};
+
+  GxrVisibilityMask mask = {
+    .vertices = vertices,
+    .vertex_count = G_N_ELEMENTS (vertices),
+    .indices = indices,
+    .index_count = G_N_ELEMENTS (indices),
+  };
+
+  float    mesh[G_N_ELEMENTS (indices) * GXR_VISIBILITY_MASK_VERTEX_SIZE];
+  uint32_t count = gxr_visibility_mask_write_mesh (&mask, fov, 1, mesh);
+  g_assert_cmpuint (count, ==, 3);
+
+  float expected[] = {
+    -1.0f, -1.0f, 0.0f, 1.0f, 1.0f, -1.0f, 0.0f, 1.0f,
+    1.0f,  1.0f,  0.0f, 1.0f,
+  };
+  for (uint32_t i = 0; i < G_N_ELEMENTS (expected); i++)
+    g_assert_cmpfloat_with_epsilon (mesh[i], expected[i], 0.0001f);
+}
+
+int
+main ()
+{
+  _test_corners_map_to_ndc ();
+  return 0;
+}